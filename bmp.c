@@ -0,0 +1,339 @@
+/***********************************************************************
+ *  File Name   : bmp.c
+ *  Description : Source file for the BMP Pixel Format Module.
+ *                Detects the pixel format of a cover image and provides
+ *                one embed/extract kernel pair per format. The kernels are
+ *                generated from a macro with the carrier positions baked
+ *                in, so the inner loop is straight-line code with no
+ *                per-pixel branching. Embedding rewrites a whole group as
+ *                one or two words from a per format spread table and
+ *                counts the carriers it changed in the same step.
+ *
+ *                Supported formats:
+ *                - 24 bpp BGR      : every byte is a carrier
+ *                - 8 bpp palette   : every palette index is a carrier; the
+ *                                    palette is not reordered, so index^1
+ *                                    can be any colour of it
+ *                - 32 bpp BGRA/BGRX: B, G, R bytes, alpha is never touched
+ *                - 16 bpp RGB555 / RGB565: lowest bit of each channel
+ *
+ *                Functions:
+ *                - get_bmp_format()
+ *                - do_format_benchmark()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "types.h"
+#include "bmp.h"
+
+#define BI_RGB 0
+#define BI_BITFIELDS 3
+
+/* Take bit s of image byte b as bit k of the payload byte */
+#define EXTRACT_BIT(img, b, s, k) \
+    ((((img)[b] >> (s)) & 1u) << (k))
+
+/* Bit 8 * b + s of the group, as it sits in the little endian group words */
+#define CARRIER(b, s) (8 * (b) + (s))
+
+/*
+ * Fill spread[w][v], the bits of group word w (bytes 0..7, 8..15) that
+ * payload byte v sets, for carriers of payload bits 7..0 at carrier[0..7]
+ */
+static void build_spread_table(const unsigned char *carrier, uint64_t spread[2][256])
+{
+    for(uint v = 0; v < 256; v++)
+    {
+        spread[0][v] = spread[1][v] = 0;
+        for(uint n = 0; n < 8; n++)
+            spread[carrier[n] / 64][v] |= (uint64_t)((v >> (7 - n)) & 1) << (carrier[n] % 64);
+    }
+}
+
+/* Group words are 8, 6 or 4 bytes, built from whole loads so nothing goes through memory */
+static inline uint64_t load_group_word(const unsigned char *image, size_t bytes)
+{
+    uint64_t word;
+    uint32_t low;
+    uint16_t high;
+    if(bytes == 8)
+    {
+        memcpy(&word, image, 8);
+        return word;
+    }
+    memcpy(&low, image, 4);
+    word = low;
+    if(bytes == 6)
+    {
+        memcpy(&high, image + 4, 2);
+        word |= (uint64_t)high << 32;
+    }
+    return word;
+}
+
+static inline void store_group_word(unsigned char *image, size_t bytes, uint64_t word)
+{
+    if(bytes == 8)
+    {
+        memcpy(image, &word, 8);
+        return;
+    }
+    uint32_t low = (uint32_t)word;
+    memcpy(image, &low, 4);
+    if(bytes == 6)
+    {
+        uint16_t high = (uint16_t)(word >> 32);
+        memcpy(image + 4, &high, 2);
+    }
+}
+
+/* Add the packed counters at every carrier's bit of the group words to phase */
+static void add_slot_counts(BmpChanges *changes, uint phase, const unsigned char *carrier, uint64_t lo, uint64_t hi, uint64_t field)
+{
+    for(uint n = 0; n < 8; n++)
+        changes->slots[phase][n] += ((carrier[n] < 64 ? lo : hi) >> (carrier[n] % 64)) & field;
+}
+
+/*
+ * Generates embed_<name>() and extract_<name>() for a format whose group
+ * of <group> image bytes carries payload bits 7..0 at (byte, bit) pairs
+ * (b0, s0) .. (b7, s7), most significant bit first. The channel layout
+ * repeats every <phases> (1 or 3) groups.
+ *
+ * Embedding works on the group as one or two words: clear the carriers,
+ * OR in the payload byte's spread from a table, and old ^ new is 1 at
+ * exactly the carriers that changed. Adding those up makes every carrier's
+ * bit the bottom of a packed counter that holds up to <run> = 2^gap - 1,
+ * gap being the closest spacing of two carriers, so they are emptied
+ * every <run> groups.
+ * 24 bpp keeps one set of counters per phase, rotated as the groups go by.
+ */
+#define DEFINE_LSB_KERNELS(name, group, phases, run, b0, s0, b1, s1, b2, s2, b3, s3, b4, s4, b5, s5, b6, s6, b7, s7) \
+static const unsigned char carrier_##name[8] = \
+    { CARRIER(b0, s0), CARRIER(b1, s1), CARRIER(b2, s2), CARRIER(b3, s3), \
+      CARRIER(b4, s4), CARRIER(b5, s5), CARRIER(b6, s6), CARRIER(b7, s7) }; \
+static uint64_t spread_##name[2][256]; \
+static void init_##name(void) \
+{ \
+    build_spread_table(carrier_##name, spread_##name); \
+} \
+static void embed_##name(unsigned char *image, const unsigned char *data, size_t count, BmpChanges *changes) \
+{ \
+    const size_t lo_bytes = (group) < 8 ? (group) : 8, hi_bytes = (group) - lo_bytes; \
+    const uint64_t lo_mask = spread_##name[0][255], hi_mask = spread_##name[1][255]; \
+    uint phase = changes->phase; \
+    while(count > 0) \
+    { \
+        size_t len = count < (run) ? count : (run); \
+        uint64_t lo0 = 0, lo1 = 0, lo2 = 0, hi0 = 0; \
+        for(size_t i = 0; i < len; i++, image += (group)) \
+        { \
+            uint64_t lo = load_group_word(image, lo_bytes); \
+            uint64_t new_lo = (lo & ~lo_mask) | spread_##name[0][data[i]]; \
+            store_group_word(image, lo_bytes, new_lo); \
+            lo0 += lo ^ new_lo; \
+            if(hi_bytes) \
+            { \
+                uint64_t hi = load_group_word(image + 8, hi_bytes); \
+                uint64_t new_hi = (hi & ~hi_mask) | spread_##name[1][data[i]]; \
+                store_group_word(image + 8, hi_bytes, new_hi); \
+                hi0 += hi ^ new_hi; \
+            } \
+            if((phases) == 3) \
+            { \
+                uint64_t t = lo0; \
+                lo0 = lo1; \
+                lo1 = lo2; \
+                lo2 = t; \
+            } \
+        } \
+        /* lo0 now belongs to the phase of the next group, lo1 and lo2 to the ones after */ \
+        phase = (phase + len) % (phases); \
+        add_slot_counts(changes, phase, carrier_##name, lo0, hi0, (run)); \
+        if((phases) == 3) \
+        { \
+            add_slot_counts(changes, (phase + 1) % 3, carrier_##name, lo1, 0, (run)); \
+            add_slot_counts(changes, (phase + 2) % 3, carrier_##name, lo2, 0, (run)); \
+        } \
+        data += len; \
+        count -= len; \
+    } \
+    changes->phase = phase; \
+} \
+static void extract_##name(const unsigned char *image, unsigned char *data, size_t count) \
+{ \
+    for(size_t i = 0; i < count; i++, image += (group)) \
+    { \
+        data[i] = (unsigned char)(EXTRACT_BIT(image, b0, s0, 7) | EXTRACT_BIT(image, b1, s1, 6) | \
+                                  EXTRACT_BIT(image, b2, s2, 5) | EXTRACT_BIT(image, b3, s3, 4) | \
+                                  EXTRACT_BIT(image, b4, s4, 3) | EXTRACT_BIT(image, b5, s5, 2) | \
+                                  EXTRACT_BIT(image, b6, s6, 1) | EXTRACT_BIT(image, b7, s7, 0)); \
+    } \
+}
+
+/* 24 bpp: 8 consecutive bytes, same layout as the original encoder */
+DEFINE_LSB_KERNELS(bgr24, 8, 3, 255, 0, 0, 1, 0, 2, 0, 3, 0, 4, 0, 5, 0, 6, 0, 7, 0)
+/* 8 bpp: 8 consecutive palette indexes */
+DEFINE_LSB_KERNELS(pal8, 8, 1, 255, 0, 0, 1, 0, 2, 0, 3, 0, 4, 0, 5, 0, 6, 0, 7, 0)
+/* 32 bpp: 3 pixels, B G R of each, alpha (bytes 3, 7, 11) untouched, 9th channel unused */
+DEFINE_LSB_KERNELS(bgra32, 12, 1, 255, 0, 0, 1, 0, 2, 0, 4, 0, 5, 0, 6, 0, 8, 0, 9, 0)
+/* 16 bpp 5-5-5: 3 little endian pixels, channel LSBs at pixel bits 0, 5, 10 */
+DEFINE_LSB_KERNELS(rgb555, 6, 1, 31, 0, 0, 0, 5, 1, 2, 2, 0, 2, 5, 3, 2, 4, 0, 4, 5)
+/* 16 bpp 5-6-5: 3 little endian pixels, channel LSBs at pixel bits 0, 5, 11 */
+DEFINE_LSB_KERNELS(rgb565, 6, 1, 31, 0, 0, 0, 5, 1, 3, 2, 0, 2, 5, 3, 3, 4, 0, 4, 5)
+
+/* Carriers are B G R B G R B G in every format with colour channels, 24 bpp
+ * groups of 8 bytes start one channel further back each time */
+static const BmpFormat bmp_formats[] =
+{
+    { "bgr24",  24, 8,  embed_bgr24,  extract_bgr24,  3, 3, { "B", "G", "R" }, { 255, 255, 255 },
+      { { 0, 1, 2, 0, 1, 2, 0, 1 }, { 2, 0, 1, 2, 0, 1, 2, 0 }, { 1, 2, 0, 1, 2, 0, 1, 2 } } },
+    { "pal8",   8,  8,  embed_pal8,   extract_pal8,   1, 1, { "Index" }, { 0 },
+      { { 0, 0, 0, 0, 0, 0, 0, 0 } } },
+    { "bgra32", 32, 12, embed_bgra32, extract_bgra32, 1, 3, { "B", "G", "R" }, { 255, 255, 255 },
+      { { 0, 1, 2, 0, 1, 2, 0, 1 } } },
+    { "rgb555", 16, 6,  embed_rgb555, extract_rgb555, 1, 3, { "B", "G", "R" }, { 31, 31, 31 },
+      { { 0, 1, 2, 0, 1, 2, 0, 1 } } },
+    { "rgb565", 16, 6,  embed_rgb565, extract_rgb565, 1, 3, { "B", "G", "R" }, { 31, 63, 31 },
+      { { 0, 1, 2, 0, 1, 2, 0, 1 } } },
+};
+
+#define FORMAT_BGR24 0
+#define FORMAT_PAL8 1
+#define FORMAT_BGRA32 2
+#define FORMAT_RGB555 3
+#define FORMAT_RGB565 4
+#define FORMAT_COUNT (sizeof(bmp_formats) / sizeof(bmp_formats[0]))
+
+static pthread_once_t bmp_once = PTHREAD_ONCE_INIT;
+
+/* Spread tables of every format, built the first time a format is needed */
+static void init_bmp_tables(void)
+{
+    init_bgr24();
+    init_pal8();
+    init_bgra32();
+    init_rgb555();
+    init_rgb565();
+}
+
+Status get_bmp_format(FILE *fptr_image, const BmpFormat **format, uint *pixel_offset)
+{
+    uint32_t offset, compression, masks[4] = {0};
+    uint16_t bpp;
+
+    pthread_once(&bmp_once, init_bmp_tables);
+    // Pixel data offset, bits per pixel and compression from the header
+    if(fseek(fptr_image, BMP_PIXEL_OFFSET_POS, SEEK_SET) != 0 || fread(&offset, 4, 1, fptr_image) != 1 ||
+       fseek(fptr_image, BMP_BPP_POS, SEEK_SET) != 0 || fread(&bpp, 2, 1, fptr_image) != 1 ||
+       fseek(fptr_image, BMP_COMPRESSION_POS, SEEK_SET) != 0 || fread(&compression, 4, 1, fptr_image) != 1)
+    {
+        fprintf(stderr, "Error: Failed to read BMP Header\n");
+        return e_failure;
+    }
+    if(offset < BMP_MIN_HEADER_SIZE)
+    {
+        fprintf(stderr, "Error: Corrupt BMP Header, pixel data at %u\n", offset);
+        return e_failure;
+    }
+    // Channel masks follow the info header when the format is bit fields
+    if(compression == BI_BITFIELDS)
+    {
+        fseek(fptr_image, BMP_MASKS_POS, SEEK_SET);
+        if(fread(masks, 4, offset >= BMP_MASKS_POS + 16 ? 4 : 3, fptr_image) < 3)
+        {
+            fprintf(stderr, "Error: Failed to read BMP channel masks\n");
+            return e_failure;
+        }
+    }
+
+    *format = NULL;
+    if(bpp == 24 && compression == BI_RGB)
+        *format = &bmp_formats[FORMAT_BGR24];
+    else if(bpp == 8 && compression == BI_RGB)
+        *format = &bmp_formats[FORMAT_PAL8];
+    else if(bpp == 32 && (compression == BI_RGB ||
+            (masks[0] == 0x00FF0000 && masks[1] == 0x0000FF00 && masks[2] == 0x000000FF)))
+        *format = &bmp_formats[FORMAT_BGRA32];
+    else if(bpp == 16 && (compression == BI_RGB ||
+            (masks[0] == 0x7C00 && masks[1] == 0x03E0 && masks[2] == 0x001F)))
+        *format = &bmp_formats[FORMAT_RGB555];
+    else if(bpp == 16 && masks[0] == 0xF800 && masks[1] == 0x07E0 && masks[2] == 0x001F)
+        *format = &bmp_formats[FORMAT_RGB565];
+
+    if(*format == NULL)
+    {
+        fprintf(stderr, "Error: Unsupported BMP format (%u bpp, compression %u)\n", bpp, compression);
+        return e_failure;
+    }
+    *pixel_offset = offset;
+    return e_success;
+}
+
+static double elapsed_seconds(struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+Status do_format_benchmark(uint megabytes)
+{
+    pthread_once(&bmp_once, init_bmp_tables);
+    size_t count = (size_t)megabytes * 1024 * 1024;
+    unsigned char *data = malloc(count);
+    unsigned char *check = malloc(count);
+    unsigned char *image = malloc(count * MAX_GROUP_SIZE);
+    if(data == NULL || check == NULL || image == NULL)
+    {
+        fprintf(stderr, "Error: Unable to allocate %u MB benchmark buffers\n", megabytes);
+        free(data);
+        free(check);
+        free(image);
+        return e_failure;
+    }
+    // Same pseudo random payload and cover for every format
+    for(size_t i = 0; i < count; i++)
+        data[i] = (unsigned char)(i * 2654435761u >> 13);
+    for(size_t i = 0; i < count * MAX_GROUP_SIZE; i++)
+        image[i] = (unsigned char)(i * 40503u >> 7);
+
+    Status ret = e_success;
+    printf("%-8s %10s %12s %12s\n", "format", "payload", "embed MB/s", "extract MB/s");
+    for(uint f = 0; f < FORMAT_COUNT; f++)
+    {
+        const BmpFormat *format = &bmp_formats[f];
+        BmpChanges changes = {{{0}}, 0};
+        struct timespec start;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        format->embed(image, data, count, &changes);
+        double embed_time = elapsed_seconds(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        format->extract(image, check, count);
+        double extract_time = elapsed_seconds(&start);
+
+        if(memcmp(data, check, count) != 0)
+        {
+            fprintf(stderr, "Error: %s kernels do not round trip\n", format->name);
+            ret = e_failure;
+        }
+        // Rates are payload bytes per second
+        printf("%-8s %8u MB %12.1f %12.1f\n", format->name, megabytes, megabytes / embed_time, megabytes / extract_time);
+    }
+    free(data);
+    free(check);
+    free(image);
+    return ret;
+}
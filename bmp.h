@@ -0,0 +1,83 @@
+/***********************************************************************
+ *  File Name   : bmp.h
+ *  Description : Header file for the BMP Pixel Format Module.
+ *                Contains the pixel format descriptor and declarations of
+ *                the per format LSB embed/extract kernels.
+ *
+ *                Structures:
+ *                - BmpFormat
+ *
+ *                Functions:
+ *                - get_bmp_format()
+ *                - do_format_benchmark()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef BMP_H
+#define BMP_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "types.h"
+
+/* Offsets of the BMP header fields we read */
+#define BMP_PIXEL_OFFSET_POS 10
+#define BMP_WIDTH_POS 18
+#define BMP_BPP_POS 28
+#define BMP_COMPRESSION_POS 30
+#define BMP_MASKS_POS 54
+#define BMP_MIN_HEADER_SIZE 54
+
+/* Largest group of image bytes carrying one payload byte (32 bpp) */
+#define MAX_GROUP_SIZE 12
+/* Smallest group of image bytes carrying one payload byte (16 bpp) */
+#define MIN_GROUP_SIZE 6
+
+/* 24 bpp groups start on B, R or G in turn, every other format on the same channel */
+#define BMP_MAX_PHASES 3
+/* Most colour channels a format has (B, G, R), alpha never carries data */
+#define BMP_MAX_CHANNELS 3
+
+/* Changed carriers counted by the embed kernels while they write */
+typedef struct _BmpChanges
+{
+    uint64_t slots[BMP_MAX_PHASES][8]; // => Store the changes of carrier 0..7 of a group, by phase
+    uint phase;                  // => Store the phase of the next group
+
+} BmpChanges;
+
+/*
+ * Pixel format of a cover image. Every payload byte is spread over
+ * group_size image bytes (8 colour channels), so a payload byte always
+ * starts on a group boundary and the kernels need no per-pixel state.
+ */
+typedef struct _BmpFormat
+{
+    const char *name;           // => Store the format name
+    uint bpp;                   // => Store the bits per pixel
+    uint group_size;            // => Store the image bytes per payload byte
+
+    /* Embed count payload bytes into count groups of image bytes, counting the changes */
+    void (*embed)(unsigned char *image, const unsigned char *data, size_t count, BmpChanges *changes);
+    /* Extract count payload bytes from count groups of image bytes */
+    void (*extract)(const unsigned char *image, unsigned char *data, size_t count);
+
+    /* Channel layout, for the distortion metrics */
+    uint phases;                // => Store the groups after which the layout repeats
+    uint channels;              // => Store the number of colour channels
+    const char *channel_names[BMP_MAX_CHANNELS]; // => Store the channel names
+    uint channel_peak[BMP_MAX_CHANNELS];         // => Store every channel's largest value (0 => not a colour, counts only)
+    unsigned char slot_channel[BMP_MAX_PHASES][8]; // => Store the channel of carrier 0..7, by phase
+
+} BmpFormat;
+
+/* Get the pixel format and the pixel data offset of a BMP image */
+Status get_bmp_format(FILE *fptr_image, const BmpFormat **format, uint *pixel_offset);
+
+/* Time every format's kernels over an in-memory buffer */
+Status do_format_benchmark(uint megabytes);
+
+#endif
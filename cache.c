@@ -0,0 +1,462 @@
+/***********************************************************************
+ *  File Name   : cache.c
+ *  Description : Source file for the Result Cache Module.
+ *                A retried job with the same cover, secret, key and
+ *                options gives the same stego image, so the finished
+ *                image is kept in a cache directory under a 128 bit key
+ *                (two XXH64 passes with different seeds, streamed over
+ *                the inputs). A hit puts the entry in place of the output
+ *                by reflink, else a plain copy, and skips encoding
+ *                altogether. Outputs never share an inode with an entry,
+ *                so editing one cannot reach the cache, and keep their own
+ *                owner and mode; the directory and its entries are private
+ *                to the user (0700 / 0600) like the images they hold.
+ *                Entry mtimes record their last use; once the directory
+ *                goes over its size limit the least recently used entries
+ *                are removed. The counters file is also the lock that
+ *                serialises updates between processes and daemon workers.
+ *
+ *                Functions:
+ *                - do_cached_encoding()
+ *                - get_cache_key()
+ *                - place_cached_output()
+ *                - store_cached_output()
+ *                - update_cache_counters()
+ *                - evict_cache_entries()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+/* 64-bit off_t for fseeko()/pread() on multi-gigabyte images */
+#define _FILE_OFFSET_BITS 64
+/* mkstemp(), utimensat() and friends */
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+#include "types.h"
+#include "encode.h"
+#include "cache.h"
+
+/* Bump when the stego layout changes so old entries stop matching */
+#define CACHE_KEY_VERSION "stego-cache-2"
+
+/* XXH64 primes */
+#define XXH_PRIME1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME3 0x165667B19E3779F9ULL
+#define XXH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME5 0x27D4EB2F165667C5ULL
+
+/* Streaming XXH64 state, fed in pieces of any size */
+typedef struct _Xxh64
+{
+    uint64_t v[4];
+    uint64_t seed;
+    uint64_t total;
+    unsigned char buffer[32];
+    uint buffered;
+
+} Xxh64;
+
+static uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t read64(const unsigned char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_PRIME2;
+    return rotl64(acc, 31) * XXH_PRIME1;
+}
+
+static uint64_t xxh64_merge(uint64_t acc, uint64_t v)
+{
+    acc ^= xxh64_round(0, v);
+    return acc * XXH_PRIME1 + XXH_PRIME4;
+}
+
+static void xxh64_init(Xxh64 *state, uint64_t seed)
+{
+    memset(state, 0, sizeof(*state));
+    state->seed = seed;
+    state->v[0] = seed + XXH_PRIME1 + XXH_PRIME2;
+    state->v[1] = seed + XXH_PRIME2;
+    state->v[2] = seed;
+    state->v[3] = seed - XXH_PRIME1;
+}
+
+static void xxh64_stripe(Xxh64 *state, const unsigned char *p)
+{
+    for(int i = 0; i < 4; i++)
+        state->v[i] = xxh64_round(state->v[i], read64(p + 8 * i));
+}
+
+static void xxh64_update(Xxh64 *state, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    state->total += len;
+    // Topping up a part filled stripe first
+    if(state->buffered)
+    {
+        size_t take = 32 - state->buffered < len ? 32 - state->buffered : len;
+        memcpy(state->buffer + state->buffered, p, take);
+        state->buffered += take;
+        p += take;
+        len -= take;
+        if(state->buffered < 32)
+            return;
+        xxh64_stripe(state, state->buffer);
+        state->buffered = 0;
+    }
+    for(; len >= 32; p += 32, len -= 32)
+        xxh64_stripe(state, p);
+    memcpy(state->buffer, p, len);
+    state->buffered = len;
+}
+
+static uint64_t xxh64_digest(const Xxh64 *state)
+{
+    uint64_t h;
+    const unsigned char *p = state->buffer;
+    uint len = state->buffered;
+    if(state->total >= 32)
+    {
+        h = rotl64(state->v[0], 1) + rotl64(state->v[1], 7) + rotl64(state->v[2], 12) + rotl64(state->v[3], 18);
+        for(int i = 0; i < 4; i++)
+            h = xxh64_merge(h, state->v[i]);
+    }
+    else
+        h = state->seed + XXH_PRIME5;
+    h += state->total;
+    for(; len >= 8; p += 8, len -= 8)
+        h = rotl64(h ^ xxh64_round(0, read64(p)), 27) * XXH_PRIME1 + XXH_PRIME4;
+    if(len >= 4)
+    {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        h = rotl64(h ^ (v * XXH_PRIME1), 23) * XXH_PRIME2 + XXH_PRIME3;
+        p += 4;
+        len -= 4;
+    }
+    for(; len > 0; p++, len--)
+        h = rotl64(h ^ (*p * XXH_PRIME5), 11) * XXH_PRIME1;
+    h ^= h >> 33;
+    h *= XXH_PRIME2;
+    h ^= h >> 29;
+    h *= XXH_PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+/* Feed both halves of the key */
+static void update_key(Xxh64 *halves, const void *data, size_t len)
+{
+    xxh64_update(&halves[0], data, len);
+    xxh64_update(&halves[1], data, len);
+}
+
+/* Length first, so neighbouring fields cannot run into each other */
+static Status hash_file(Xxh64 *halves, FILE *fptr)
+{
+    unsigned char buffer[MAX_CHUNK_SIZE];
+    size_t len;
+    uint64_t size = get_file_size(fptr);
+    update_key(halves, &size, sizeof(size));
+    fseeko(fptr, 0, SEEK_SET);
+    while((len = fread(buffer, 1, sizeof(buffer), fptr)) > 0)
+        update_key(halves, buffer, len);
+    return ferror(fptr) ? e_failure : e_success;
+}
+
+static void hash_string(Xxh64 *halves, const char *str)
+{
+    uint64_t len = strlen(str);
+    update_key(halves, &len, sizeof(len));
+    update_key(halves, str, len);
+}
+
+Status get_cache_key(EncodeInfo *encInfo, char *key)
+{
+    Xxh64 halves[2];
+    xxh64_init(&halves[0], 0);
+    xxh64_init(&halves[1], XXH_PRIME5);
+
+    // Everything the stego image depends on; --verify does not change it
+    uint options[2] = { encInfo->fec_parity, encInfo->matrix_k };
+    hash_string(halves, CACHE_KEY_VERSION);
+    hash_string(halves, encInfo->magic_string);
+    hash_string(halves, encInfo->extn_secret_file);
+    update_key(halves, options, sizeof(options));
+    if(hash_file(halves, encInfo->fptr_src_image) == e_failure || hash_file(halves, encInfo->fptr_secret) == e_failure)
+    {
+        fprintf(stderr, "Error: Failed to read the inputs for the cache key\n");
+        return e_failure;
+    }
+    snprintf(key, CACHE_KEY_LEN + 1, "%016" PRIx64 "%016" PRIx64, xxh64_digest(&halves[0]), xxh64_digest(&halves[1]));
+    return e_success;
+}
+
+/* Copy everything from in to out, both from offset 0 */
+static Status copy_fd_data(int in, int out)
+{
+    unsigned char buffer[MAX_CHUNK_SIZE];
+    off_t offset = 0;
+    ssize_t len;
+    while((len = pread(in, buffer, sizeof(buffer), offset)) > 0)
+    {
+        if(pwrite(out, buffer, len, offset) != len)
+            return e_failure;
+        offset += len;
+    }
+    return len == 0 ? e_success : e_failure;
+}
+
+/* Share in's blocks with out (copy on write), where the filesystem can */
+static Status reflink_fd(int in, int out)
+{
+#ifdef FICLONE
+    if(ioctl(out, FICLONE, in) == 0)
+        return e_success;
+#endif
+    return e_failure;
+}
+
+Status place_cached_output(const char *entry, EncodeInfo *encInfo, const char **how)
+{
+    int in = open(entry, O_RDONLY);
+    if(in < 0)
+        return e_failure;
+    // The output is already open (and empty), possibly on a descriptor handed in by a client
+    fflush(encInfo->fptr_stego_image);
+    int out = fileno(encInfo->fptr_stego_image);
+    Status ret = e_success;
+    if(reflink_fd(in, out) == e_success)
+        *how = "reflinked";
+    // Never a hard link, the output would share the entry's inode, mtime and mode
+    else
+    {
+        ret = copy_fd_data(in, out);
+        *how = "copied";
+        // pwrite() left the FILE position behind, keep it at the end
+        fseeko(encInfo->fptr_stego_image, 0, SEEK_END);
+    }
+    // A copy that failed partway must not stay in front of the encode that
+    // replaces it; pwrite() cannot have written to anything but a regular file
+    struct stat st;
+    if(ret == e_failure && fstat(out, &st) == 0 && S_ISREG(st.st_mode))
+    {
+        if(ftruncate(out, 0) == 0)
+            rewind(encInfo->fptr_stego_image);
+        else
+        {
+            perror("ftruncate");
+            *how = NULL;
+        }
+    }
+    close(in);
+    // Entry mtime is its last use for the LRU, no output shares it
+    utimensat(AT_FDCWD, entry, NULL, 0);
+    return ret;
+}
+
+Status store_cached_output(const char *entry, EncodeInfo *encInfo)
+{
+    char tmp[PATH_MAX];
+    // A private (0600) temp file, renamed into place so readers never see a half written entry
+    if(snprintf(tmp, sizeof(tmp), "%s/.tmpXXXXXX", encInfo->cache_dir) >= (int)sizeof(tmp))
+        return e_failure;
+    int out = mkstemp(tmp);
+    if(out < 0)
+        return e_failure;
+    if(fflush(encInfo->fptr_stego_image) != 0)
+    {
+        close(out);
+        unlink(tmp);
+        return e_failure;
+    }
+    // Copied (or reflinked) rather than hard linked, so later edits of the output cannot reach the cache
+    int in = fileno(encInfo->fptr_stego_image);
+    Status ret = reflink_fd(in, out);
+    if(ret == e_failure)
+        ret = copy_fd_data(in, out);
+    close(out);
+    if(ret == e_failure || rename(tmp, entry) != 0)
+    {
+        unlink(tmp);
+        return e_failure;
+    }
+    return e_success;
+}
+
+/* One cache entry seen while looking for eviction candidates */
+typedef struct _CacheEntry
+{
+    char name[CACHE_KEY_LEN + sizeof(CACHE_ENTRY_SUFFIX)];
+    struct timespec used;
+    uint64_t size;
+
+} CacheEntry;
+
+static int compare_entry_age(const void *a, const void *b)
+{
+    const CacheEntry *x = a, *y = b;
+    if(x->used.tv_sec != y->used.tv_sec)
+        return x->used.tv_sec < y->used.tv_sec ? -1 : 1;
+    if(x->used.tv_nsec != y->used.tv_nsec)
+        return x->used.tv_nsec < y->used.tv_nsec ? -1 : 1;
+    return 0;
+}
+
+uint64_t evict_cache_entries(const char *dir, uint64_t limit)
+{
+    DIR *dp = opendir(dir);
+    if(dp == NULL)
+        return 0;
+    CacheEntry *entries = NULL;
+    size_t count = 0, room = 0;
+    uint64_t total = 0, evicted = 0;
+    struct dirent *de;
+    while((de = readdir(dp)) != NULL)
+    {
+        // Only "<key>.bmp" names, the counters and temp files are left alone
+        size_t len = strlen(de->d_name);
+        if(len != CACHE_KEY_LEN + strlen(CACHE_ENTRY_SUFFIX) || strcmp(de->d_name + CACHE_KEY_LEN, CACHE_ENTRY_SUFFIX) != 0)
+            continue;
+        struct stat st;
+        if(fstatat(dirfd(dp), de->d_name, &st, 0) != 0)
+            continue;
+        if(count == room)
+        {
+            room = room ? room * 2 : 64;
+            CacheEntry *grown = realloc(entries, room * sizeof(*entries));
+            if(grown == NULL)
+                break;
+            entries = grown;
+        }
+        strcpy(entries[count].name, de->d_name);
+        entries[count].used = st.st_mtim;
+        entries[count].size = st.st_size;
+        total += st.st_size;
+        count++;
+    }
+    // Oldest use first
+    if(total > limit)
+    {
+        qsort(entries, count, sizeof(*entries), compare_entry_age);
+        for(size_t i = 0; i < count && total > limit; i++)
+        {
+            if(unlinkat(dirfd(dp), entries[i].name, 0) == 0 || errno == ENOENT)
+            {
+                total -= entries[i].size;
+                evicted++;
+            }
+        }
+    }
+    free(entries);
+    closedir(dp);
+    return evicted;
+}
+
+Status update_cache_counters(const char *dir, uint64_t limit, CacheCounters *counters)
+{
+    char path[PATH_MAX];
+    CacheCounters totals = {0};
+    snprintf(path, sizeof(path), "%s/%s", dir, CACHE_COUNTERS_FILE);
+    int fd = open(path, O_RDWR | O_CREAT, 0600);
+    if(fd < 0 || flock(fd, LOCK_EX) != 0)
+    {
+        if(fd >= 0)
+            close(fd);
+        return e_failure;
+    }
+    // "hits misses evictions", missing or damaged counts restart from 0
+    char text[96] = {0};
+    if(pread(fd, text, sizeof(text) - 1, 0) > 0)
+        sscanf(text, "%" SCNu64 " %" SCNu64 " %" SCNu64, &totals.hits, &totals.misses, &totals.evictions);
+    totals.hits += counters->hits;
+    totals.misses += counters->misses;
+    // New entries only ever come with a miss, that is when the size can go over
+    if(counters->misses)
+        totals.evictions += evict_cache_entries(dir, limit);
+    int len = snprintf(text, sizeof(text), "%" PRIu64 " %" PRIu64 " %" PRIu64 "\n", totals.hits, totals.misses, totals.evictions);
+    if(pwrite(fd, text, len, 0) != len || ftruncate(fd, len) != 0)
+        perror("counters");
+    close(fd);
+    *counters = totals;
+    return e_success;
+}
+
+Status do_cached_encoding(EncodeInfo *encInfo)
+{
+    char key[CACHE_KEY_LEN + 1];
+    char entry[PATH_MAX];
+    CacheCounters counters = {0};
+    const char *how = "";
+
+    // The key covers the magic string, so it is needed up front
+    if(encInfo->magic_string[0] == '\0' && prompt_magic_string(encInfo) == e_failure)
+        return e_failure;
+    // Entries are stego images, kept from other users like the outputs themselves
+    if(mkdir(encInfo->cache_dir, 0700) != 0 && errno != EEXIST)
+    {
+        perror("mkdir");
+        fprintf(stderr, "ERROR: Unable to use cache directory \"%s\"\n", encInfo->cache_dir);
+        return e_failure;
+    }
+    if(open_files(encInfo) == e_failure || get_cache_key(encInfo, key) == e_failure)
+        return e_failure;
+    if(snprintf(entry, sizeof(entry), "%s/%s%s", encInfo->cache_dir, key, CACHE_ENTRY_SUFFIX) >= (int)sizeof(entry))
+    {
+        fprintf(stderr, "Error: Cache directory name \"%s\" is too long\n", encInfo->cache_dir);
+        return e_failure;
+    }
+
+    if(access(entry, R_OK) == 0 && place_cached_output(entry, encInfo, &how) == e_success)
+    {
+        counters.hits = 1;
+        printf("Cache Hit %s, Output %s Successfully\n", key, how);
+    }
+    else
+    {
+        if(how == NULL)
+        {
+            fprintf(stderr, "Error: Cache copy to the output failed partway and could not be undone\n");
+            return e_failure;
+        }
+        // Same steps as an uncached encode, then keep the result
+        if(encode_stego_image(encInfo) == e_failure)
+            return e_failure;
+        counters.misses = 1;
+        if(store_cached_output(entry, encInfo) == e_success)
+            printf("Cache Miss %s, Output Stored Successfully\n", key);
+        else
+            printf("Cache Miss %s, Output could not be stored (write only output?)\n", key);
+    }
+    if(update_cache_counters(encInfo->cache_dir, encInfo->cache_limit, &counters) == e_success)
+        printf("Cache hits %" PRIu64 ", misses %" PRIu64 ", evictions %" PRIu64 "\n", counters.hits, counters.misses, counters.evictions);
+    return e_success;
+}
@@ -0,0 +1,66 @@
+/***********************************************************************
+ *  File Name   : cache.h
+ *  Description : Header file for the Result Cache Module.
+ *                Contains the definitions and function declarations used
+ *                for serving repeated encode jobs from an on-disk cache of
+ *                stego images, keyed by a hash of every input.
+ *
+ *                Structures:
+ *                - CacheCounters
+ *
+ *                Functions:
+ *                - do_cached_encoding()
+ *                - get_cache_key()
+ *                - place_cached_output()
+ *                - store_cached_output()
+ *                - update_cache_counters()
+ *                - evict_cache_entries()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include "types.h"
+#include "encode.h"
+
+/* Entries are "<key>.bmp", the key being 128 bits in hex */
+#define CACHE_KEY_LEN 32
+#define CACHE_ENTRY_SUFFIX ".bmp"
+/* Hit / miss / eviction counts, shared by every job using the directory */
+#define CACHE_COUNTERS_FILE "counters"
+/* Cache size when --cache-size is not given */
+#define DEFAULT_CACHE_MB 1024
+
+typedef struct _CacheCounters
+{
+    uint64_t hits;              // => Store jobs served from the cache
+    uint64_t misses;            // => Store jobs encoded and then stored
+    uint64_t evictions;         // => Store entries removed to stay in the size limit
+
+} CacheCounters;
+
+/* Encode through the cache in encInfo->cache_dir */
+Status do_cached_encoding(EncodeInfo *encInfo);
+
+/* Hash the cover, the secret and everything that changes the output */
+Status get_cache_key(EncodeInfo *encInfo, char *key);
+
+/* Fill the open output from a cache entry, reflink > copy. A failed copy is
+   cut back to an empty output, how is set to NULL when even that fails */
+Status place_cached_output(const char *entry, EncodeInfo *encInfo, const char **how);
+
+/* Save the finished output as a cache entry, reflink > copy */
+Status store_cached_output(const char *entry, EncodeInfo *encInfo);
+
+/* Add to the directory's counters, returns the new totals in counters */
+Status update_cache_counters(const char *dir, uint64_t limit, CacheCounters *counters);
+
+/* Remove least recently used entries until the cache fits in limit bytes */
+uint64_t evict_cache_entries(const char *dir, uint64_t limit);
+
+#endif
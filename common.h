@@ -7,6 +7,12 @@
  *                - MAGIC_STRING : A unique identifier used during encoding
  *                                  and decoding to validate whether the image
  *                                  contains embedded (stego) data.
+ *                - STEGO_FLAG_* : Bits of the 32 bit flags field stored
+ *                                  right after the magic string.
+ *                - STEGO_HEADER_VERSION : Layout version, kept in the top
+ *                                  byte of the flags field.
+ *                - MAX_FNAME / MAX_MAGIC_LEN : Sizes of the name and key
+ *                                  buffers every job carries.
  *
  *  Author      : Pankaj Kumar
  *  Roll No     : 25008_018
@@ -16,7 +22,37 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+/* File name buffers of a job, terminating NUL included */
+#define MAX_FNAME 50
+/* Longest magic string (key) */
+#define MAX_MAGIC_LEN 49
+
 /* Magic string to identify whether stegged or not */
 #define MAGIC_STRING "#*"
 
+/* Header flags, stored as a 32 bit field after the magic string */
+#define STEGO_FLAG_SHARD 0x1    // Image carries one shard of a larger secret
+#define STEGO_FLAG_FEC 0x2      // Secret data is Reed-Solomon coded
+#define STEGO_FLAG_MATRIX 0x4   // Secret data is Hamming matrix embedded
+/* Flags this build understands, decoding refuses anything else */
+#define STEGO_FLAGS_SUPPORTED (STEGO_FLAG_SHARD | STEGO_FLAG_FEC | STEGO_FLAG_MATRIX)
+
+/* Header layout version, in the top byte of the flags field. Version 0 is the
+   original layout with no flags field: the magic string is followed directly
+   by the extension size (always below 256, so its top byte is 0), the
+   extension and a 32 bit secret size. Version 1 adds the flags field and a
+   64 bit secret size */
+#define STEGO_HEADER_VERSION 1
+#define STEGO_VERSION_SHIFT 24
+#define STEGO_FLAGS_MASK ((1u << STEGO_VERSION_SHIFT) - 1)
+
+/* Shard header: payload id, shard index, shard count (32 bits each) */
+#define SHARD_HEADER_SIZE 12
+
+/* FEC header: parity bytes per 255 byte codeword (32 bits) */
+#define FEC_HEADER_SIZE 4
+
+/* Matrix header: message bits k per Hamming unit (32 bits) */
+#define MATRIX_HEADER_SIZE 4
+
 #endif
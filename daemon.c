@@ -0,0 +1,395 @@
+/***********************************************************************
+ *  File Name   : daemon.c
+ *  Description : Source file for the Steganography Daemon Module.
+ *                Keeps a pool of worker threads blocked in accept() on a
+ *                Unix domain socket so each encode/decode job skips the
+ *                process spawn and runs on an already warm thread. Jobs
+ *                look at their connection at every progress report, so a
+ *                client that hangs up stops its job instead of leaving it
+ *                running to the end.
+ *
+ *                Functions:
+ *                - read_and_validate_daemon_args()
+ *                - do_daemon()
+ *                - open_daemon_socket()
+ *                - daemon_worker()
+ *                - receive_daemon_request()
+ *                - handle_daemon_request()
+ *                - adopt_request_fds()
+ *                - report_daemon_progress()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "types.h"
+#include "encode.h"
+#include "decode.h"
+#include "daemon.h"
+#include "options.h"
+#include "cache.h"
+
+/* Longest token accepted, matches the name buffers of the encode/decode args */
+#define DAEMON_MAX_TOKEN MAX_FNAME
+
+Status read_and_validate_daemon_args(char *argv[], DaemonInfo *daeInfo)
+{
+    struct sockaddr_un addr;
+    // argv[2] is the socket path, it has to fit in sun_path
+    if(strlen(argv[2]) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "Error: Socket path \"%s\" is too long\n", argv[2]);
+        return e_failure;
+    }
+    daeInfo->socket_path = argv[2];
+    daeInfo->thread_count = DAEMON_DEFAULT_THREADS;
+    // If argv[3] is present it is the worker thread count
+    if(argv[3] != NULL)
+    {
+        int count = atoi(argv[3]);
+        if(count <= 0 || count > DAEMON_MAX_THREADS)
+        {
+            fprintf(stderr, "Error: Thread count should be between 1 and %d\n", DAEMON_MAX_THREADS);
+            return e_failure;
+        }
+        daeInfo->thread_count = count;
+    }
+    return e_success;
+}
+
+Status do_daemon(DaemonInfo *daeInfo)
+{
+    pthread_t workers[DAEMON_MAX_THREADS];
+    uint started = 0;
+
+    // A client hanging up before the reply must not kill the daemon
+    signal(SIGPIPE, SIG_IGN);
+    if(open_daemon_socket(daeInfo) == e_failure)
+        return e_failure;
+
+    // Starting the worker pool, every worker blocks in accept() on the same socket
+    for(uint i = 0; i < daeInfo->thread_count; i++)
+    {
+        if(pthread_create(&workers[i], NULL, daemon_worker, daeInfo) != 0)
+        {
+            fprintf(stderr, "Error: Failed to start worker thread %u\n", i);
+            break;
+        }
+        started++;
+    }
+    if(started == 0)
+    {
+        close(daeInfo->listen_fd);
+        return e_failure;
+    }
+    printf("Daemon listening on \"%s\" with %u workers\n", daeInfo->socket_path, started);
+    fflush(stdout);
+
+    for(uint i = 0; i < started; i++)
+        pthread_join(workers[i], NULL);
+    close(daeInfo->listen_fd);
+    // Only our own socket, the path may since belong to another daemon or file
+    struct stat st;
+    if(lstat(daeInfo->socket_path, &st) == 0 && S_ISSOCK(st.st_mode) && st.st_dev == daeInfo->socket_dev && st.st_ino == daeInfo->socket_ino)
+        unlink(daeInfo->socket_path);
+    return e_success;
+}
+
+/* Clear path for bind(), only if it is a socket no daemon is listening on */
+static Status remove_stale_socket(const char *path, const struct sockaddr_un *addr)
+{
+    struct stat st;
+    if(lstat(path, &st) != 0)
+        return errno == ENOENT ? e_success : e_failure;
+    if(!S_ISSOCK(st.st_mode))
+    {
+        fprintf(stderr, "Error: \"%s\" exists and is not a socket\n", path);
+        return e_failure;
+    }
+    // A socket somebody still accepts on is a running daemon, not a stale one
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(probe < 0)
+        return e_failure;
+    int ret = connect(probe, (const struct sockaddr *)addr, sizeof(*addr));
+    int err = errno;
+    close(probe);
+    if(ret == 0)
+    {
+        fprintf(stderr, "Error: A daemon is already listening on \"%s\"\n", path);
+        return e_failure;
+    }
+    if(err != ECONNREFUSED)
+    {
+        errno = err;
+        perror("connect");
+        fprintf(stderr, "ERROR: Unable to tell whether \"%s\" is in use\n", path);
+        return e_failure;
+    }
+    return unlink(path) == 0 || errno == ENOENT ? e_success : e_failure;
+}
+
+Status open_daemon_socket(DaemonInfo *daeInfo)
+{
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, daeInfo->socket_path);
+
+    daeInfo->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(daeInfo->listen_fd < 0)
+    {
+        perror("socket");
+        return e_failure;
+    }
+    // Removing a stale socket left behind by a previous run, nothing else
+    if(remove_stale_socket(daeInfo->socket_path, &addr) == e_failure)
+    {
+        close(daeInfo->listen_fd);
+        return e_failure;
+    }
+    struct stat st;
+    if(bind(daeInfo->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(daeInfo->listen_fd, 64) < 0 ||
+       lstat(daeInfo->socket_path, &st) != 0)
+    {
+        perror("bind/listen");
+        fprintf(stderr, "ERROR: Unable to listen on \"%s\"\n", daeInfo->socket_path);
+        close(daeInfo->listen_fd);
+        return e_failure;
+    }
+    daeInfo->socket_dev = st.st_dev;
+    daeInfo->socket_ino = st.st_ino;
+    return e_success;
+}
+
+void *daemon_worker(void *arg)
+{
+    DaemonInfo *daeInfo = arg;
+    // Request buffer lives for the whole life of the worker
+    char request[DAEMON_MAX_REQUEST];
+    int fds[DAEMON_MAX_FDS];
+    int fd_count;
+
+    while(1)
+    {
+        int conn_fd = accept(daeInfo->listen_fd, NULL, NULL);
+        if(conn_fd < 0)
+            continue;
+        Status ret = e_failure;
+        DaemonClient client = { conn_fd, 0, -1, "" };
+        if(receive_daemon_request(conn_fd, request, fds, &fd_count) == e_success)
+            ret = handle_daemon_request(&client, request, fds, fd_count);
+        else
+        {
+            // Descriptors of a bad request are never adopted, drop them here
+            for(int i = 0; i < fd_count; i++)
+                close(fds[i]);
+        }
+        // A memfd decode's secret goes back with the reply, and is then the client's alone
+        if(client.secret_fd >= 0)
+        {
+            send_secret_fd(conn_fd, client.reply, client.secret_fd);
+            close(client.secret_fd);
+        }
+        else
+        {
+            const char *reply = (ret == e_success) ? "OK\n" : "ERR\n";
+            if(write(conn_fd, reply, strlen(reply)) < 0)
+                perror("write");
+        }
+        close(conn_fd);
+    }
+    return NULL;
+}
+
+Status receive_daemon_request(int conn_fd, char *request, int *fds, int *fd_count)
+{
+    char control[CMSG_SPACE(sizeof(int) * DAEMON_MAX_FDS)];
+    struct iovec iov = { request, DAEMON_MAX_REQUEST - 1 };
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    *fd_count = 0;
+    // Descriptors travel with the first chunk of the request
+    ssize_t len = recvmsg(conn_fd, &msg, 0);
+    if(len <= 0)
+        return e_failure;
+    for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+            *fd_count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            memcpy(fds, CMSG_DATA(cmsg), *fd_count * sizeof(int));
+        }
+    }
+    if(msg.msg_flags & MSG_CTRUNC)
+    {
+        fprintf(stderr, "Error: Too many descriptors in request\n");
+        return e_failure;
+    }
+    // Reading the rest of the line
+    while(memchr(request, '\n', len) == NULL && len < DAEMON_MAX_REQUEST - 1)
+    {
+        ssize_t more = read(conn_fd, request + len, DAEMON_MAX_REQUEST - 1 - len);
+        if(more <= 0)
+            break;
+        len += more;
+    }
+    request[len] = '\0';
+    return e_success;
+}
+
+Status handle_daemon_request(DaemonClient *client, char *request, int *fds, int fd_count)
+{
+    // Building an argv the same shape as the command line one
+    char *argv[DAEMON_MAX_ARGS + 1] = { "stego" };
+    int argc = 1;
+    char *save;
+    for(char *tok = strtok_r(request, " \t\r\n", &save); tok != NULL; tok = strtok_r(NULL, " \t\r\n", &save))
+    {
+        if(argc == DAEMON_MAX_ARGS || strlen(tok) >= DAEMON_MAX_TOKEN)
+        {
+            fprintf(stderr, "Error: Malformed daemon request\n");
+            goto drop_fds;
+        }
+        argv[argc++] = tok;
+    }
+    argv[argc] = NULL;
+    if(argc < 3)
+    {
+        fprintf(stderr, "Error: Malformed daemon request\n");
+        goto drop_fds;
+    }
+    // argv[1] is the operation and argv[2] the magic string, drop the
+    // magic string first, it may well start with "--" itself, so argv
+    // matches "stego -e <src> <secret> [out]"
+    char *magic = argv[2];
+    memmove(&argv[2], &argv[3], (argc - 2) * sizeof(char *));
+    argc--;
+    // Same --options as the command line, the daemon never runs commands,
+    // connects anywhere or writes to its own descriptors for a client
+    // (--exec, --send and --fd are left out of DAEMON_*_OPTIONS)
+    Options options = {0};
+    if(read_options(&argc, argv, &options) == e_failure || argc < 3)
+    {
+        fprintf(stderr, "Error: Malformed daemon request\n");
+        goto drop_fds;
+    }
+    // Progress of the job goes to its client, never to the daemon's own stderr
+    client->progress = options.progress;
+
+    if(strcmp(argv[1], "e") == 0 && argc >= 4)
+    {
+        EncodeInfo encInfo = {0};
+        const char *modes[] = { "rb", "rb", "wb" };
+        FILE *fptrs[3] = { NULL };
+        if(check_options(&options, DAEMON_ENCODE_OPTIONS, "daemon encode requests") == e_failure ||
+           read_and_validate_encode_args(argv, &encInfo) == e_failure)
+            goto drop_fds;
+        if(adopt_request_fds(fds, fd_count, modes, fptrs, 3) == e_failure)
+            return e_failure;
+        encInfo.fptr_src_image = fptrs[0];
+        encInfo.fptr_secret = fptrs[1];
+        encInfo.fptr_stego_image = fptrs[2];
+        strcpy(encInfo.magic_string, magic);
+        encInfo.fec_parity = options.fec_parity;
+        encInfo.matrix_k = options.matrix_k;
+        encInfo.verify = options.verify;
+        encInfo.map_threads = options.map_threads;
+        encInfo.cache_dir = options.cache_dir;
+        encInfo.cache_limit = (uint64_t)(options.cache_mb ? options.cache_mb : DEFAULT_CACHE_MB) << 20;
+        encInfo.progress.callback = report_daemon_progress;
+        encInfo.progress.callback_arg = client;
+        return do_encoding(&encInfo);
+    }
+    if(strcmp(argv[1], "d") == 0)
+    {
+        DecodeInfo decInfo = {0};
+        const char *modes[] = { "rb", "wb" };
+        FILE *fptrs[2] = { NULL };
+        if(check_options(&options, DAEMON_DECODE_OPTIONS, "daemon decode requests") == e_failure ||
+           read_and_validate_decode_args(argv, &decInfo) == e_failure)
+            goto drop_fds;
+        // A memfd decode has no output descriptor, only the image
+        if(adopt_request_fds(fds, fd_count, modes, fptrs, options.memfd ? 1 : 2) == e_failure)
+            return e_failure;
+        decInfo.fptr_stego_image = fptrs[0];
+        decInfo.fptr_secret = fptrs[1];
+        strcpy(decInfo.magic_string, magic);
+        decInfo.progress.callback = report_daemon_progress;
+        decInfo.progress.callback_arg = client;
+        decInfo.memfd = options.memfd;
+        if(do_decoding(&decInfo) == e_failure)
+            return e_failure;
+        if(decInfo.memfd)
+        {
+            client->secret_fd = decInfo.secret_fd;
+            snprintf(client->reply, sizeof(client->reply), "OK %s %" PRIu64 "\n", decInfo.secret_fname, decInfo.secret_size);
+        }
+        return e_success;
+    }
+    fprintf(stderr, "Error: Invalid daemon Operation => %s\n", argv[1]);
+
+drop_fds:
+    for(int i = 0; i < fd_count; i++)
+        close(fds[i]);
+    return e_failure;
+}
+
+Status adopt_request_fds(int *fds, int fd_count, const char **modes, FILE **fptrs, int expected)
+{
+    // No descriptors => files are opened by name as usual
+    if(fd_count == 0)
+        return e_success;
+    if(fd_count != expected)
+    {
+        fprintf(stderr, "Error: Expected %d descriptors, got %d\n", expected, fd_count);
+        for(int i = 0; i < fd_count; i++)
+            close(fds[i]);
+        return e_failure;
+    }
+    for(int i = 0; i < fd_count; i++)
+    {
+        fptrs[i] = fdopen(fds[i], modes[i]);
+        if(fptrs[i] == NULL)
+        {
+            perror("fdopen");
+            for(int j = 0; j < i; j++)
+                fclose(fptrs[j]);
+            for(int j = i; j < fd_count; j++)
+                close(fds[j]);
+            return e_failure;
+        }
+    }
+    return e_success;
+}
+
+int report_daemon_progress(const JobProgress *progress, const char *line, void *arg)
+{
+    (void)progress;
+    DaemonClient *client = arg;
+    // POLLHUP only comes once the client closed its end for good, a client
+    // that just shut down its writing side still waits for the reply
+    struct pollfd pfd = { client->conn_fd, 0, 0 };
+    if(poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLHUP | POLLERR)))
+        return 1;
+    // SIGPIPE is ignored, a failed write is also a client that left
+    if(client->progress && write(client->conn_fd, line, strlen(line)) < 0)
+        return 1;
+    return 0;
+}
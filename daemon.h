@@ -0,0 +1,98 @@
+/***********************************************************************
+ *  File Name   : daemon.h
+ *  Description : Header file for the Steganography Daemon Module.
+ *                Contains structure definition and function declarations
+ *                used for serving encode/decode jobs over a local Unix
+ *                domain socket from a pool of warm worker threads.
+ *
+ *                Structures:
+ *                - DaemonInfo
+ *                - DaemonClient
+ *
+ *                Functions:
+ *                - read_and_validate_daemon_args()
+ *                - do_daemon()
+ *                - open_daemon_socket()
+ *                - daemon_worker()
+ *                - receive_daemon_request()
+ *                - handle_daemon_request()
+ *                - adopt_request_fds()
+ *                - report_daemon_progress()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <sys/types.h>
+#include "types.h"
+#include "progress.h"
+#include "handoff.h"
+
+/*
+ * Request protocol (one line per connection, reply "OK\n" or "ERR\n"):
+ *   e <magic> <source.bmp> <secret.ext> [output.bmp] [--fec[=parity]] [--matrix[=k]]
+ *     [--verify[=digest]] [--cache=dir [--cache-size=MB]]
+ *   d <magic> <stego.bmp> [output_file]
+ * The file names may be backed by descriptors sent with the request
+ * (SCM_RIGHTS), in argument order, so no payload crosses the socket.
+ * With --progress the client gets "progress ..." lines before the reply.
+ * A decode with --memfd (and only the image as a descriptor) is answered
+ * "OK <name> <size>\n" with the sealed memfd of the secret attached.
+ * A client that hangs up cancels its job at the next report.
+ */
+
+#define DAEMON_DEFAULT_THREADS 4
+#define DAEMON_MAX_THREADS 64
+#define DAEMON_MAX_REQUEST 1024
+#define DAEMON_MAX_ARGS 12
+#define DAEMON_MAX_FDS 3
+
+typedef struct _DaemonInfo
+{
+    char *socket_path;          // => Store the Unix socket path
+    int listen_fd;              // => Store the listening socket
+    uint thread_count;          // => Store the number of worker threads
+    dev_t socket_dev;           // => Store the device of the socket file we bound
+    ino_t socket_ino;           // => Store its inode, only that file is removed at exit
+
+} DaemonInfo;
+
+/* Connection a job reports to */
+typedef struct _DaemonClient
+{
+    int conn_fd;                // => Store the client's connection
+    uint progress;              // => Store 1 if the client asked for progress lines
+    int secret_fd;              // => Store a decoded memfd sent with the reply (-1 => none)
+    char reply[HANDOFF_LINE_SIZE + 4]; // => Store the reply going with secret_fd
+
+} DaemonClient;
+
+/* Read and validate Daemon args from argv */
+Status read_and_validate_daemon_args(char *argv[], DaemonInfo *daeInfo);
+
+/* Run the daemon until it is killed */
+Status do_daemon(DaemonInfo *daeInfo);
+
+/* Create, bind and listen on the Unix socket */
+Status open_daemon_socket(DaemonInfo *daeInfo);
+
+/* Worker thread, accepts and serves one connection at a time */
+void *daemon_worker(void *arg);
+
+/* Read one request line and any attached descriptors */
+Status receive_daemon_request(int conn_fd, char *request, int *fds, int *fd_count);
+
+/* Parse and run one request */
+Status handle_daemon_request(DaemonClient *client, char *request, int *fds, int fd_count);
+
+/* Wrap received descriptors into FILE pointers */
+Status adopt_request_fds(int *fds, int fd_count, const char **modes, FILE **fptrs, int expected);
+
+/* Progress hook of daemon jobs, cancels the job once the client is gone */
+int report_daemon_progress(const JobProgress *progress, const char *line, void *arg);
+
+#endif
@@ -10,50 +10,79 @@
  *                - open_secret_file()
  *                - read_and_validate_decode_args()
  *                - do_decoding()
+ *                - decode_stego_image()
+ *                - decode_stego_header()
+ *                - close_decode_files()
  *                - decode_data_from_image()
- *                - decode_byte_from_lsb()
+ *                - decode_matrix_data_from_image()
  *                - get_magic_string()
  *                - decode_magic_string()
+ *                - decode_header_flags()
+ *                - decode_shard_header()
+ *                - decode_fec_header()
+ *                - decode_matrix_header()
  *                - decode_secret_file_extn_size()
  *                - decode_secret_file_extn()
  *                - decode_secret_file_size()
  *                - decode_secret_file_data()
  *                - decode_int_from_lsb()
+ *                - decode_long_from_lsb()
  *
  *  Author      : Pankaj Kumar
  *  Roll No     : 25008_018
  *  Date        : 30-Jul-2025
  ***********************************************************************/
 
+/* 64-bit off_t for fseeko() on multi-gigabyte images */
+#define _FILE_OFFSET_BITS 64
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <inttypes.h>
 
 #include "types.h"
 #include "common.h"
 #include "decode.h"
+#include "bmp.h"
+#include "fec.h"
+#include "matrix.h"
+#include "plane.h"
+#include "handoff.h"
 
 Status open_image_file(DecodeInfo *decInfo)
 {
-    decInfo->fptr_stego_image = fopen(decInfo->stego_image_fname, "rb");
+    // An image handed in by the caller (e.g. daemon fd passing) is used as is
+    if(decInfo->fptr_stego_image == NULL)
+        decInfo->fptr_stego_image = fopen(decInfo->stego_image_fname, "rb");
     if(decInfo->fptr_stego_image == NULL)
     {
     	fprintf(stderr, "ERROR: No source File found with name \"%s\"\n", decInfo->stego_image_fname);
     	return e_failure;
     }
+    set_job_buffer(decInfo->fptr_stego_image, &decInfo->context, JOB_BUFFER_SRC);
     return e_success;
 }
 
 Status open_secret_file(DecodeInfo *decInfo)
 {
+    // An output handed in by the caller is written as is, no name to fix up
+    if(decInfo->fptr_secret != NULL)
+    {
+        set_job_buffer(decInfo->fptr_secret, &decInfo->context, JOB_BUFFER_SECRET);
+        return e_success;
+    }
     char *ptr = strchr(decInfo->secret_fname, '.');
     // Replacing the file extension after the dot to the encoded extension if exists
     if(ptr != NULL)
         strcpy(ptr, decInfo->extn_secret_file);
     else
         strcpy(decInfo->secret_fname + strlen(decInfo->secret_fname), decInfo->extn_secret_file);
-    // opening the secret file in binary write mode
-    decInfo->fptr_secret = fopen(decInfo->secret_fname, "wb");
+    // Nothing on disk at all, the name only labels the memfd
+    if(decInfo->memfd)
+        return open_secret_memfd(decInfo);
+    // opening the secret file in binary write mode, under a temp name until the job succeeds
+    decInfo->fptr_secret = open_temp_output(decInfo->secret_fname, decInfo->secret_temp_fname, sizeof(decInfo->secret_temp_fname), "wb");
     // Do Error handling
     if(decInfo->fptr_secret == NULL)
     {
@@ -61,6 +90,7 @@ Status open_secret_file(DecodeInfo *decInfo)
     	fprintf(stderr, "ERROR: Unable to open file %s\n", decInfo->secret_fname);
     	return e_failure;
     }
+    set_job_buffer(decInfo->fptr_secret, &decInfo->context, JOB_BUFFER_SECRET);
     printf("Secret file with name \"%s\" created Successfully\n", decInfo->secret_fname);
     // No failure return e_success
     return e_success;
@@ -69,19 +99,32 @@ Status open_secret_file(DecodeInfo *decInfo)
 Status read_and_validate_decode_args(char *argv[], DecodeInfo *decInfo)
 {
     // If argv[2] is .bmp file
-    decInfo->stego_image_fname = malloc(50);
     char *ext = strstr(argv[2], ".bmp");
     if (ext != NULL && strcmp(ext, ".bmp") == 0)
+    {
+        if(strlen(argv[2]) >= MAX_FNAME)
+        {
+            fprintf(stderr, "Error: File name \"%s\" is longer than %d characters\n", argv[2], MAX_FNAME - 1);
+            return e_failure;
+        }
         strcpy(decInfo->stego_image_fname, argv[2]);
+    }
     else
     {
         fprintf(stderr, "Error: Source_Image Should be \".bmp\" File\n");
         return e_failure;
     }
-    decInfo->secret_fname = malloc(50);
     // If argv[3] Exists 
     if(argv[3] != NULL)
+    {
+        // Leaving room for the decoded extension that open_secret_file() appends
+        if(strlen(argv[3]) >= MAX_FNAME - MAX_FILE_SUFFIX)
+        {
+            fprintf(stderr, "Error: File name \"%s\" is longer than %d characters\n", argv[3], MAX_FNAME - MAX_FILE_SUFFIX - 1);
+            return e_failure;
+        }
         strcpy(decInfo->secret_fname, argv[3]);
+    }
     else
     {
         // Default secret file name
@@ -92,83 +135,202 @@ Status read_and_validate_decode_args(char *argv[], DecodeInfo *decInfo)
 
 Status do_decoding(DecodeInfo *decInfo)
 {
+    Status ret = e_failure;
+    decInfo->secret_fd = -1;
+    // Without pool buffers the files fall back to stdio's own
+    acquire_job_context(&decInfo->context);
     // opening the image in binary read mode
-    if(open_image_file(decInfo) == e_failure)
+    if(open_image_file(decInfo) == e_success)
+        ret = decode_stego_image(decInfo);
+
+    // Freeing the LSB Plane, the names live in decInfo itself
+    free(decInfo->plane);
+    decInfo->plane = NULL;
+    // closing the open files, also on failure so long running callers don't leak them
+    if(ret == e_success && decInfo->secret_temp_fname[0] && fflush(decInfo->fptr_secret) != 0)
+    {
+        perror("fflush");
+        ret = e_failure;
+    }
+    close_decode_files(decInfo);
+    // A finished memfd is sealed for its consumer, a failed one dropped
+    ret = seal_secret_memfd(decInfo, ret);
+    // A finished secret replaces the old one in one step, anything else is removed
+    ret = commit_temp_output(decInfo->secret_temp_fname, decInfo->secret_fname, ret);
+    finish_job_progress(&decInfo->progress, ret);
+    // The buffers go back only once no FILE uses them
+    release_job_context(&decInfo->context);
+    print_job_allocations(&decInfo->context);
+    if(ret == e_success)
+        printf("Decoding Completed Successfully\n");
+    return ret;
+}
+
+Status decode_stego_image(DecodeInfo *decInfo)
+{
+    if(decode_stego_header(decInfo) == e_failure) return e_failure;
+    // A single shard is only part of the secret, it needs all its siblings
+    if(decInfo->flags & STEGO_FLAG_SHARD)
+    {
+        fprintf(stderr, "Error: \"%s\" holds shard %u of %u, use -R with all the shards\n", decInfo->stego_image_fname, decInfo->shard_index + 1, decInfo->shard_count);
+        return e_failure;
+    }
+    // opening the secrat file
+    if(open_secret_file(decInfo) == e_failure) return e_failure;
+    // Setup is done, nothing from here to the last block should allocate
+    mark_job_data_pass(&decInfo->context);
+    if(decode_secret_file_data(decInfo) == e_failure) return e_failure;
+    return e_success;
+}
+
+Status decode_stego_header(DecodeInfo *decInfo)
+{
+    // Pixel format decides which bytes carry the data
+    if(get_bmp_format(decInfo->fptr_stego_image, &decInfo->format, &decInfo->pixel_offset) == e_failure)
         return e_failure;
     // setting the file pointer after the header
-    fseek(decInfo->fptr_stego_image, 54, SEEK_SET);
+    fseeko(decInfo->fptr_stego_image, decInfo->pixel_offset, SEEK_SET);
+    // Candidate keys are all tried against one extraction of the image
+    if((decInfo->key_count || decInfo->plane_cache) && load_lsb_plane(decInfo) == e_failure) return e_failure;
 
-    // To get the magic string from the user
-    if(get_magic_string(decInfo) == e_failure) return e_failure;
+    // To get the magic string from the user, unless the caller supplied one or a key list
+    if(decInfo->magic_string[0] == '\0' && decInfo->key_count == 0 && get_magic_string(decInfo) == e_failure) return e_failure;
     if(decode_magic_string(decInfo->magic_string, decInfo) == e_failure) return e_failure;
-    if(decode_secret_file_extn_size(&decInfo->extn_size, decInfo) == e_failure) return e_failure;
+    if(decode_header_flags(&decInfo->flags, decInfo) == e_failure) return e_failure;
+    // An original header had the extension size where the flags are now, already read
+    if(decInfo->header_version && decode_secret_file_extn_size(&decInfo->extn_size, decInfo) == e_failure) return e_failure;
     if(decode_secret_file_extn(decInfo->extn_secret_file, decInfo) == e_failure) return e_failure;
-    // opening the secrat file
-    if(open_secret_file(decInfo) == e_failure) return e_failure;
     if(decode_secret_file_size(&decInfo->secret_size, decInfo) == e_failure) return e_failure;
-    if(decode_secret_file_data(decInfo) == e_failure) return e_failure;
-    // Freeing the allocated memory for file names
-    free(decInfo->secret_fname);  
-    free(decInfo->stego_image_fname);
-    free(decInfo->magic_string);
-    // closing the open files
-    fclose(decInfo->fptr_secret);
-    fclose(decInfo->fptr_stego_image);
-    printf("Decoding Completed Successfully\n");
+    if((decInfo->flags & STEGO_FLAG_SHARD) && decode_shard_header(decInfo) == e_failure) return e_failure;
+    if((decInfo->flags & STEGO_FLAG_FEC) && decode_fec_header(decInfo) == e_failure) return e_failure;
+    if((decInfo->flags & STEGO_FLAG_MATRIX) && decode_matrix_header(decInfo) == e_failure) return e_failure;
     return e_success;
 }
 
-Status decode_data_from_image(char *data, int size, FILE *fptr_stego_image)
+void close_decode_files(DecodeInfo *decInfo)
 {
-    // creating buffer to read 8 butes from the encoded image   
-    unsigned char image_buffer[MAX_IMAGE_BUF_SIZE];
-    if (!data || !fptr_stego_image)
+    if(decInfo->fptr_secret)
+        fclose(decInfo->fptr_secret);
+    if(decInfo->fptr_stego_image)
+        fclose(decInfo->fptr_stego_image);
+    decInfo->fptr_secret = decInfo->fptr_stego_image = NULL;
+}
+
+Status decode_data_from_image(char *data, uint64_t size, DecodeInfo *decInfo)
+{
+    // Block buffer holding whole groups of image bytes
+    unsigned char image_buffer[MAX_CHUNK_SIZE];
+    const BmpFormat *format = decInfo->format;
+    if (!data || !decInfo->fptr_stego_image || !format)
         return e_failure;
-    
-    for(int i = 0; i < size; i++)
+    // Already extracted, the payload bytes are a copy away
+    if(decInfo->plane)
     {
-        // reading 8 bytes from the encoded mage for each 1 byte data
-        if(fread(image_buffer, MAX_IMAGE_BUF_SIZE, 1, fptr_stego_image) != 1)
+        if(size > decInfo->plane_size - decInfo->plane_pos)
             return e_failure;
-        // calling the function to decode lsb bit into the data
-        if(decode_byte_from_lsb(&data[i], image_buffer) == e_failure)
+        memcpy(data, decInfo->plane + decInfo->plane_pos, size);
+        decInfo->plane_pos += size;
+        return e_success;
+    }
+
+    uint64_t per_block = MAX_CHUNK_SIZE / format->group_size;
+    while(size > 0)
+    {
+        size_t count = size < per_block ? size : per_block;
+        // reading one block from the encoded image
+        if(fread(image_buffer, count * format->group_size, 1, decInfo->fptr_stego_image) != 1)
             return e_failure;
+        // calling the format's kernel to decode count data bytes
+        format->extract(image_buffer, (unsigned char *)data, count);
+        data += count;
+        size -= count;
     }
     return e_success;
 }
 
-Status decode_byte_from_lsb(char *data,  char *image_buffer)
+Status decode_matrix_data_from_image(char *data, uint64_t size, DecodeInfo *decInfo)
 {
-    *data = 0;
-    // Checking if the image buffer is NULL
-    if(image_buffer == NULL)
+    // Block buffer holding whole units, and the carrier bits pulled out of it
+    unsigned char image_buffer[MAX_CHUNK_SIZE];
+    unsigned char plane[MAX_CHUNK_SIZE];
+    const BmpFormat *format = decInfo->format;
+    MatrixCode *code = &decInfo->matrix;
+    if (!data || !decInfo->fptr_stego_image || !format)
         return e_failure;
-    for(int j = 0 ; j < MAX_IMAGE_BUF_SIZE; j++)
+
+    // Bits left over from the previous call come first
+    uint64_t bits = size * 8 > code->acc_bits ? size * 8 - code->acc_bits : 0;
+    uint64_t units = (bits + code->k - 1) / code->k;
+    // Already extracted, the plane bytes are the carriers
+    if(decInfo->plane)
     {
-        // getting the lsb bit from the buffer and setting it to nth position of the data 
-        *data = *data | ((image_buffer[j] & 1) << (7 - j));
+        if(units * code->unit_bytes > decInfo->plane_size - decInfo->plane_pos)
+            return e_failure;
+        size_t out = extract_matrix_units(code, decInfo->plane + decInfo->plane_pos, units, (unsigned char *)data, size);
+        decInfo->plane_pos += units * code->unit_bytes;
+        return out == size ? e_success : e_failure;
     }
-    return e_success;
+    uint64_t per_block = MAX_CHUNK_SIZE / (code->unit_bytes * format->group_size);
+    do
+    {
+        size_t count = units < per_block ? units : per_block;
+        size_t carriers = count * code->unit_bytes;
+        // reading one block from the encoded image
+        if(count && fread(image_buffer, carriers * format->group_size, 1, decInfo->fptr_stego_image) != 1)
+            return e_failure;
+        // every unit's syndrome is k message bits
+        format->extract(image_buffer, plane, carriers);
+        size_t out = extract_matrix_units(code, plane, count, (unsigned char *)data, size);
+        data += out;
+        size -= out;
+        units -= count;
+    } while(units > 0);
+    return size == 0 ? e_success : e_failure;
 }
 
 Status get_magic_string(DecodeInfo * decInfo)
 {
-    decInfo->magic_string = malloc(50);
-    memset(decInfo->magic_string, 0, 50);
     printf("Enter the magic string kays : ");
-    if(scanf(" %s", decInfo->magic_string) != 1) 
+    if(scanf(" %49s", decInfo->magic_string) != 1) 
         return e_failure;
     return e_success;
 }
 
 Status decode_magic_string(char *magic_string, DecodeInfo *decInfo)
 {
-    int len = strlen(magic_string);
-    // creating magic string buffer based on the original magic string length
-    char temp_ms[len + 1];
+    if(magic_string[0] == '\0' && decInfo->key_count)
+    {
+        // Trial decoding, each candidate is a compare against the start of the plane.
+        // The longest match wins, a shorter one would read key bytes as header fields
+        uint best = decInfo->key_count;
+        size_t best_len = 0;
+        for(uint i = 0; i < decInfo->key_count; i++)
+        {
+            size_t key_len = strlen(decInfo->keys[i]);
+            if(key_len > best_len && key_len <= decInfo->plane_size && memcmp(decInfo->plane, decInfo->keys[i], key_len) == 0)
+            {
+                best = i;
+                best_len = key_len;
+            }
+        }
+        if(best == decInfo->key_count)
+        {
+            fprintf(stderr, "Error: None of the %u candidate keys match %s\n", decInfo->key_count, decInfo->stego_image_fname);
+            return e_failure;
+        }
+        strcpy(decInfo->magic_string, decInfo->keys[best]);
+        decInfo->plane_pos = best_len;
+        printf("Magic String matched candidate key %u of %u Successfully\n", best + 1, decInfo->key_count);
+        return e_success;
+    }
+    size_t len = strlen(magic_string);
+    // magic string buffer sized for the longest key, not by the caller's string
+    char temp_ms[MAX_MAGIC_LEN + 1];
+    if(len > MAX_MAGIC_LEN)
+        return e_failure;
     temp_ms[len] = '\0';
     // calling the decode fns to decode magic string
-    if(decode_data_from_image(temp_ms, strlen(magic_string),decInfo->fptr_stego_image) == e_failure)
+    if(decode_data_from_image(temp_ms, len, decInfo) == e_failure)
     {
         fprintf(stderr, "Error: Failed to decode Magic String\n");
         return e_failure;
@@ -184,11 +346,93 @@ Status decode_magic_string(char *magic_string, DecodeInfo *decInfo)
     return e_success;
 }
 
+Status decode_header_flags(uint *flags, DecodeInfo *decInfo)
+{
+    uint word;
+    if(decode_int_from_lsb(&word, decInfo) == e_failure)
+        return e_failure;
+    decInfo->header_version = word >> STEGO_VERSION_SHIFT;
+    if(decInfo->header_version == 0)
+    {
+        // Original layout, the word is the extension size and there are no flags
+        *flags = 0;
+        decInfo->extn_size = word;
+        if(word > MAX_FILE_SUFFIX)
+        {
+            fprintf(stderr, "Error: Corrupt File extension Size %u in %s\n", word, decInfo->stego_image_fname);
+            return e_failure;
+        }
+        printf("File extion Size %d Decoded Successfully\n", word);
+        return e_success;
+    }
+    if(decInfo->header_version > STEGO_HEADER_VERSION)
+    {
+        fprintf(stderr, "Error: Unsupported header version %u\n", decInfo->header_version);
+        return e_failure;
+    }
+    *flags = word & STEGO_FLAGS_MASK;
+    // Refusing images written with features this build does not know
+    if(*flags & ~STEGO_FLAGS_SUPPORTED)
+    {
+        fprintf(stderr, "Error: Unsupported header flags 0x%x\n", *flags);
+        return e_failure;
+    }
+    return e_success;
+}
+
+Status decode_shard_header(DecodeInfo *decInfo)
+{
+    // payload id, shard index and shard count, 32 bits each
+    if(decode_int_from_lsb(&decInfo->payload_id, decInfo) == e_failure ||
+       decode_int_from_lsb(&decInfo->shard_index, decInfo) == e_failure ||
+       decode_int_from_lsb(&decInfo->shard_count, decInfo) == e_failure)
+        return e_failure;
+    if(decInfo->shard_count == 0 || decInfo->shard_index >= decInfo->shard_count)
+    {
+        fprintf(stderr, "Error: Corrupt Shard Header in %s\n", decInfo->stego_image_fname);
+        return e_failure;
+    }
+    printf("Shard %u of %u (payload %08x) Decoded Successfully\n", decInfo->shard_index + 1, decInfo->shard_count, decInfo->payload_id);
+    return e_success;
+}
+
+Status decode_fec_header(DecodeInfo *decInfo)
+{
+    if(decode_int_from_lsb(&decInfo->fec_parity, decInfo) == e_failure)
+        return e_failure;
+    if(decInfo->fec_parity < MIN_FEC_PARITY || decInfo->fec_parity > MAX_FEC_PARITY)
+    {
+        fprintf(stderr, "Error: Corrupt FEC Header in %s\n", decInfo->stego_image_fname);
+        return e_failure;
+    }
+    printf("FEC with %u parity bytes per codeword Decoded Successfully\n", decInfo->fec_parity);
+    return e_success;
+}
+
+Status decode_matrix_header(DecodeInfo *decInfo)
+{
+    if(decode_int_from_lsb(&decInfo->matrix_k, decInfo) == e_failure)
+        return e_failure;
+    if(decInfo->matrix_k < MIN_MATRIX_K || decInfo->matrix_k > MAX_MATRIX_K)
+    {
+        fprintf(stderr, "Error: Corrupt Matrix Header in %s\n", decInfo->stego_image_fname);
+        return e_failure;
+    }
+    printf("Matrix Embedding with %u bits per unit Decoded Successfully\n", decInfo->matrix_k);
+    return e_success;
+}
+
 Status decode_secret_file_extn_size(uint *file_extn_size, DecodeInfo *decInfo)
 {
     // Creating buffer for to store ext size;
-    if(decode_int_from_lsb(file_extn_size, decInfo->fptr_stego_image) == e_failure)
+    if(decode_int_from_lsb(file_extn_size, decInfo) == e_failure)
+        return e_failure;
+    // The size comes from the image, it is checked before anything is sized by it
+    if(*file_extn_size > MAX_FILE_SUFFIX)
+    {
+        fprintf(stderr, "Error: Corrupt File extension Size %u in %s\n", *file_extn_size, decInfo->stego_image_fname);
         return e_failure;
+    }
 
     printf("File extion Size %d Decoded Successfully\n", *file_extn_size);
     return e_success;
@@ -197,66 +441,128 @@ Status decode_secret_file_extn_size(uint *file_extn_size, DecodeInfo *decInfo)
 Status decode_secret_file_extn(char *file_extn, DecodeInfo *decInfo)
 {
     // Creating extension buffer to store the decoded extension
-    char extn[decInfo->extn_size];
+    char extn[MAX_FILE_SUFFIX + 1] = {0};
     // calling the decode fns to decode the file ext
-    if(decode_data_from_image(extn, decInfo->extn_size, decInfo->fptr_stego_image) == e_failure)
+    if(decode_data_from_image(extn, decInfo->extn_size, decInfo) == e_failure)
     {
         fprintf(stderr, "Error: Failed to decode File extension Name\n");
         return e_failure;
     }
     if(strstr(extn, ".txt"))
-        strncpy(decInfo->extn_secret_file, extn, 4);
+        memcpy(decInfo->extn_secret_file, extn, 4);
     else if(strstr(extn, ".jpg"))
-        strncpy(decInfo->extn_secret_file, extn, 4);
+        memcpy(decInfo->extn_secret_file, extn, 4);
     else if(strstr(extn, ".c"))
-        strncpy(decInfo->extn_secret_file, extn, 2);
+        memcpy(decInfo->extn_secret_file, extn, 2);
     else if(strstr(extn, ".sh"))
-        strncpy(decInfo->extn_secret_file, extn, 3);
+        memcpy(decInfo->extn_secret_file, extn, 3);
 
     printf("File extention \"%s\" Decoded Successfully\n", decInfo->extn_secret_file);
     return e_success;
 }
 
-Status decode_secret_file_size(uint* file_size, DecodeInfo *decInfo)
+Status decode_secret_file_size(uint64_t *file_size, DecodeInfo *decInfo)
 {
-    // Creating the buffer to store secret file size
-    if(decode_int_from_lsb(file_size, decInfo->fptr_stego_image) == e_failure)
+    // Creating the buffer to store secret file size, 32 bits in an original header
+    uint short_size;
+    if(decInfo->header_version == 0)
+    {
+        if(decode_int_from_lsb(&short_size, decInfo) == e_failure)
+            return e_failure;
+        *file_size = short_size;
+    }
+    else if(decode_long_from_lsb(file_size, decInfo) == e_failure)
         return e_failure;
 
-    printf("Secret File Size %d Decoded Successfully\n", *file_size);
+    printf("Secret File Size %" PRIu64 " Decoded Successfully\n", *file_size);
     return e_success;
 }
 
 Status decode_secret_file_data(DecodeInfo *decInfo)
 {
-    // creating buffer character to store decoded characters into the secret file
-    unsigned char secret_data[decInfo->secret_size];
-    // calling the decode fns to decode each enoded character from the encoded image
-    if(decode_data_from_image(secret_data, decInfo->secret_size , decInfo->fptr_stego_image) == e_failure)
+    // creating a fixed size buffer, the decoded secret is written chunk by chunk
+    // so a size read from the image cannot blow the stack
+    char secret_data[MAX_CHUNK_SIZE];
+    uint64_t remaining = decInfo->secret_size;
+    size_t chunk_limit = MAX_CHUNK_SIZE;
+    // With FEC every chunk is a whole number of codewords, corrected as they come in
+    unsigned char coded_data[FEC_BLOCKS_PER_CHUNK * FEC_BLOCK_SIZE];
+    uint64_t corrected = 0;
+    const FecCodec *codec = NULL;
+    // Progress is the secret written
+    start_job_progress(&decInfo->progress, decInfo->stego_image_fname, decInfo->secret_size);
+    if(decInfo->flags & STEGO_FLAG_FEC)
     {
-        fprintf(stderr, "Error: Failed to decode Secret File Data frome %s\n", decInfo->stego_image_fname);
-        return e_failure;
+        if((codec = get_fec_codec(decInfo->fec_parity)) == NULL)
+            return e_failure;
+        chunk_limit = FEC_BLOCKS_PER_CHUNK * (FEC_BLOCK_SIZE - decInfo->fec_parity);
     }
-    // writing the decode character into the secret file
-    if(fwrite(secret_data, decInfo->secret_size, 1, decInfo->fptr_secret) != 1)
-    {
-        fprintf(stderr, "Error: Failed to write secrat file data into the file %s\n", decInfo->secret_fname);
+    if((decInfo->flags & STEGO_FLAG_MATRIX) && init_matrix(&decInfo->matrix, decInfo->matrix_k) == e_failure)
         return e_failure;
+    Status (*decode_data)(char *, uint64_t, DecodeInfo *) = (decInfo->flags & STEGO_FLAG_MATRIX) ? decode_matrix_data_from_image : decode_data_from_image;
+    while(remaining > 0)
+    {
+        size_t chunk = remaining < chunk_limit ? remaining : chunk_limit;
+        Status ret;
+        // calling the decode fns to decode each enoded character from the encoded image
+        if(decInfo->flags & STEGO_FLAG_FEC)
+        {
+            ret = decode_data((char *)coded_data, get_fec_encoded_size(chunk, decInfo->fec_parity), decInfo);
+            if(ret == e_success)
+            {
+                long fixed = decode_fec_chunk(codec, coded_data, chunk, (unsigned char *)secret_data);
+                if(fixed < 0)
+                {
+                    fprintf(stderr, "Error: Too many damaged bytes to correct in %s\n", decInfo->stego_image_fname);
+                    return e_failure;
+                }
+                corrected += fixed;
+            }
+        }
+        else
+            ret = decode_data(secret_data, chunk, decInfo);
+        if(ret == e_failure)
+        {
+            fprintf(stderr, "Error: Failed to decode Secret File Data frome %s\n", decInfo->stego_image_fname);
+            return e_failure;
+        }
+        // writing the decode character into the secret file
+        if(fwrite(secret_data, chunk, 1, decInfo->fptr_secret) != 1)
+        {
+            fprintf(stderr, "Error: Failed to write secrat file data into the file %s\n", decInfo->secret_fname);
+            return e_failure;
+        }
+        remaining -= chunk;
+        // A block boundary, the only place a job reports and notices it was cancelled
+        if(update_job_progress(&decInfo->progress, chunk) == e_failure)
+            return e_failure;
     }
+    if(corrected)
+        printf("FEC Corrected %" PRIu64 " damaged bytes\n", corrected);
     printf("Secret File Data Decoded Successfully\n");
     return e_success;
 }
 
-Status decode_int_from_lsb(uint * size,  FILE *fptr_stego_image)
+Status decode_int_from_lsb(uint *size, DecodeInfo *decInfo)
 {
+    // Most significant byte first, as encode_int_to_lsb() wrote it
+    unsigned char buffer[4];
+    if(decode_data_from_image((char *)buffer, 4, decInfo) == e_failure)
+        return e_failure;
     *size = 0;
-    unsigned char buffer[32];
-    for(int i = 0; i < 32; i++)
-    {
-        if(fread(&buffer[i], 1, 1, fptr_stego_image) != 1)
-            return e_failure;
-        
-        *size = ((buffer[i] & 1) << (31 - i)) | *size;
-    }
+    for(int i = 0; i < 4; i++)
+        *size = (*size << 8) | buffer[i];
     return e_success;
-}
\ No newline at end of file
+}
+
+Status decode_long_from_lsb(uint64_t *size, DecodeInfo *decInfo)
+{
+    // Most significant byte first, same as decode_int_from_lsb()
+    unsigned char buffer[8];
+    if(decode_data_from_image((char *)buffer, 8, decInfo) == e_failure)
+        return e_failure;
+    *size = 0;
+    for(int i = 0; i < 8; i++)
+        *size = (*size << 8) | buffer[i];
+    return e_success;
+}
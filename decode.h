@@ -11,17 +11,25 @@
  *                Functions:
  *                - read_and_validate_decode_args()
  *                - do_decoding()
+ *                - decode_stego_image()
+ *                - decode_stego_header()
+ *                - close_decode_files()
  *                - open_image_file()
  *                - open_secret_file()
  *                - get_magic_string()
  *                - decode_magic_string()
+ *                - decode_header_flags()
+ *                - decode_shard_header()
+ *                - decode_fec_header()
+ *                - decode_matrix_header()
  *                - decode_secret_file_extn_size()
  *                - decode_secret_file_extn()
  *                - decode_secret_file_size()
  *                - decode_secret_file_data()
  *                - decode_data_from_image()
- *                - decode_byte_from_lsb()
+ *                - decode_matrix_data_from_image()
  *                - decode_int_from_lsb()
+ *                - decode_long_from_lsb()
  *
  *  Author      : Pankaj Kumar
  *  Roll No     : 25008_018
@@ -33,6 +41,11 @@
 
 #include <stdio.h>
 #include "types.h" 
+#include "common.h"
+#include "bmp.h"
+#include "matrix.h"
+#include "pool.h"
+#include "progress.h"
 
 /* 
  * Structure to store information required for
@@ -41,22 +54,52 @@
  * also stored
  */
 
-#define MAX_SECRET_BUF_SIZE 1
-#define MAX_IMAGE_BUF_SIZE (MAX_SECRET_BUF_SIZE * 8)
 #define MAX_FILE_SUFFIX 4
+/* Secret data is streamed out through a buffer of this size */
+#define MAX_CHUNK_SIZE (64 * 1024)
 
 typedef struct _DecodeInfo
 {
     /* Secret File Info */
-    char *secret_fname;        // => Store the Secret file name
+    char secret_fname[MAX_FNAME]; // => Store the Secret file name
+    char secret_temp_fname[TEMP_FNAME_SIZE]; // => Store the name written until the job succeeds ("" => none)
     FILE *fptr_secret;          // => Store the Secret file pointer
     char extn_secret_file[MAX_FILE_SUFFIX + 1]; // => Store the Secret file extension
     uint extn_size;              // => store the extn Size
-    uint secret_size;            // => Store secret file size
-    char *magic_string;          // => Store the Magic String
+    uint64_t secret_size;        // => Store secret file size
+    char magic_string[MAX_MAGIC_LEN + 1]; // => Store the Magic String ("" => prompt user)
+    uint flags;                  // => Store the STEGO_FLAG_* header flags
+    uint header_version;         // => Store the header layout (0 => original, no flags, 32 bit size)
+    /* Shard Info, valid when flags has STEGO_FLAG_SHARD */
+    uint payload_id;             // => Store the id shared by all shards
+    uint shard_index;            // => Store this shard's position
+    uint shard_count;            // => Store the number of shards
+    /* FEC Info, valid when flags has STEGO_FLAG_FEC */
+    uint fec_parity;             // => Store RS parity bytes per codeword
+    /* Matrix Embedding Info, valid when flags has STEGO_FLAG_MATRIX */
+    uint matrix_k;               // => Store message bits per Hamming unit
+    MatrixCode matrix;           // => Store the secret data's extraction state
     /* Stego Image Info */
-    char *stego_image_fname;    // => Store the Stego Image file name
+    char stego_image_fname[MAX_FNAME]; // => Store the Stego Image file name
     FILE *fptr_stego_image;     // => Store the Stego Image file pointer
+    const BmpFormat *format;     // => Store the pixel format of the Stego Image
+    uint pixel_offset;           // => Store where the pixel data starts
+    /* LSB Plane Info, the header and data are decoded from plane when it is set */
+    unsigned char *plane;        // => Store every payload byte of the image
+    uint64_t plane_size;         // => Store the payload bytes in plane
+    uint64_t plane_pos;          // => Store the next payload byte to decode
+    uint plane_cache;            // => Store whether the plane is kept in "<image>.lsb"
+    /* Trial decoding Info, used when no magic string is given */
+    char **keys;                 // => Store the candidate magic strings
+    uint key_count;              // => Store the number of candidates
+    /* Handoff Info, the secret goes to a sealed memfd instead of a file when memfd is set */
+    uint memfd;                  // => Store 1 to decode into a memfd
+    int secret_fd;               // => Store the sealed memfd after a good decode (-1 => none)
+    const char *handoff_command; // => Store the command run on the memfd (NULL => none)
+    const char *handoff_socket;  // => Store the Unix socket the memfd is sent to (NULL => none)
+    /* Job Info */
+    JobContext context;          // => Store the pool buffers behind the job's files
+    JobProgress progress;        // => Store the secret bytes written, and the progress hooks
 
 } DecodeInfo;
 
@@ -66,15 +109,36 @@ Status read_and_validate_decode_args(char *argv[], DecodeInfo *decInfo);
 /* Perform the decoding */
 Status do_decoding(DecodeInfo *decInfo);
 
+/* Run the decoding steps on an already opened image */
+Status decode_stego_image(DecodeInfo *decInfo);
+
+/* Decode and validate everything in front of the secret data */
+Status decode_stego_header(DecodeInfo *decInfo);
+
+/* Close any open i/p and o/p files */
+void close_decode_files(DecodeInfo *decInfo);
+
 /* Get File pointers for i/p file */
 Status open_image_file(DecodeInfo *decInfo);
 
 /* Get File pointers for o/p file */
 Status open_secret_file(DecodeInfo *decInfo);
 
-/* Decode Magic String */
+/* Decode Magic String, or find it among decInfo->keys when it is "" */
 Status decode_magic_string(char *magic_string, DecodeInfo *decInfo);
 
+/* Dencode header flags */
+Status decode_header_flags(uint *flags, DecodeInfo *decInfo);
+
+/* Dencode shard index, count and payload id */
+Status decode_shard_header(DecodeInfo *decInfo);
+
+/* Dencode FEC parity bytes per codeword */
+Status decode_fec_header(DecodeInfo *decInfo);
+
+/* Dencode message bits per Hamming unit */
+Status decode_matrix_header(DecodeInfo *decInfo);
+
 /* Get Magic string from user*/
 Status get_magic_string(DecodeInfo * decInfo);
 
@@ -85,17 +149,21 @@ Status decode_secret_file_extn(char *file_extn, DecodeInfo *decInfo);
 Status decode_secret_file_extn_size(uint *file_extn_size, DecodeInfo *decInfo);
 
 /* Dencode secret file size */
-Status decode_secret_file_size(uint *file_size, DecodeInfo *decInfo);
+Status decode_secret_file_size(uint64_t *file_size, DecodeInfo *decInfo);
 
 /* Dencode secret file data*/
 Status decode_secret_file_data(DecodeInfo *decInfo);
 
-/* Dencode function, which does the real encoding */
-Status decode_data_from_image(char *data, int size, FILE *fptr_stego_image);
+/* Dencode function, which does the real decoding, a block at a time */
+Status decode_data_from_image(char *data, uint64_t size, DecodeInfo *decInfo);
+
+/* Matrix extract size bytes following the previous call's */
+Status decode_matrix_data_from_image(char *data, uint64_t size, DecodeInfo *decInfo);
 
-/* Dencode a byte into LSB of image data array */
-Status decode_byte_from_lsb(char *data,  char *image_buffer);
+/* Dencode a 32 bit int, MSB first */
+Status decode_int_from_lsb(uint *size, DecodeInfo *decInfo);
 
-Status decode_int_from_lsb(uint * size,  FILE *fptr_stego_image);
+/* Dencode a 64 bit size, MSB first */
+Status decode_long_from_lsb(uint64_t *size, DecodeInfo *decInfo);
 
 #endif
\ No newline at end of file
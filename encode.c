@@ -9,46 +9,87 @@
  *                - open_files()
  *                - check_operation_type()
  *                - read_and_validate_encode_args()
+ *                - copy_file_name()
  *                - do_encoding()
+ *                - encode_stego_image()
+ *                - prompt_magic_string()
+ *                - close_files()
  *                - check_capacity()
+ *                - get_header_size()
  *                - get_file_size()
  *                - copy_bmp_header()
  *                - encode_magic_string()
+ *                - encode_header_flags()
+ *                - encode_shard_header()
+ *                - encode_fec_header()
+ *                - encode_matrix_header()
  *                - encode_data_to_image()
- *                - encode_byte_to_lsb()
+ *                - encode_matrix_data_to_image()
  *                - encode_secret_file_extn_size()
  *                - encode_secret_file_extn()
  *                - encode_secret_file_size()
  *                - encode_secret_file_data()
  *                - encode_int_to_lsb()
+ *                - encode_long_to_lsb()
  *                - copy_remaining_img_data()
+ *                - read_image_block()
+ *                - write_stego_data()
+ *                - verify_matrix_block()
+ *                - verify_stego_digest()
  *
  *  Author      : Pankaj Kumar
  *  Roll No     : 25008_018
  *  Date        : 30-Jul-2025
  ***********************************************************************/
 
+/* 64-bit off_t for fseeko()/ftello() on multi-gigabyte images */
+#define _FILE_OFFSET_BITS 64
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "encode.h"
 #include "types.h"
 #include "common.h"
+#include "bmp.h"
+#include "fec.h"
+#include "matrix.h"
+#include "metrics.h"
+#include "cache.h"
+#include "mapped.h"
+
+/* FNV-1a 64, byte at a time so it does not depend on how the writes were split */
+#define DIGEST_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define DIGEST_PRIME 0x100000001b3ULL
 
 /* Function Definitions */
 
+static uint64_t update_digest(uint64_t digest, const unsigned char *data, size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+        digest = (digest ^ data[i]) * DIGEST_PRIME;
+    return digest;
+}
+
 /* Get image size
  * Input: Image file ptr
- * Output: width * height * bytes per pixel (3 in our case)
+ * Output: size of the pixel data in bytes (rows padded to 4 bytes)
  * Description: In BM P Image, width is stored in offset 18,
- * and height after that. size is 4 bytes
+ * and height after that. size is 4 bytes, signed (negative
+ * height => top-down image). Bits per pixel is at offset 28.
+ * Product is done in 64 bits
  */
-uint get_image_size_for_bmp(FILE *fptr_image)
+uint64_t get_image_size_for_bmp(FILE *fptr_image)
 {
-    uint width, height;
+    int32_t width = 0, height = 0;
+    uint16_t bpp = 0;
     // Seek to 18th byte
-    fseek(fptr_image, 18, SEEK_SET);
+    fseek(fptr_image, BMP_WIDTH_POS, SEEK_SET);
 
     // Read the width (an int)
     fread(&width, sizeof(int), 1, fptr_image);
@@ -56,8 +97,16 @@ uint get_image_size_for_bmp(FILE *fptr_image)
     // Read the height (an int)
     fread(&height, sizeof(int), 1, fptr_image);
 
+    // Read the bits per pixel (a short)
+    fseek(fptr_image, BMP_BPP_POS, SEEK_SET);
+    fread(&bpp, sizeof(bpp), 1, fptr_image);
+
+    // Negated through 64 bits, so INT32_MIN from a hostile header stays defined
+    uint64_t abs_width = width < 0 ? -(int64_t)width : width;
+    uint64_t abs_height = height < 0 ? -(int64_t)height : height;
     // Return image capacity
-    return width * height * 3;
+    uint64_t row_size = (abs_width * bpp + 31) / 32 * 4;
+    return row_size * abs_height;
 }
 
 /* 
@@ -69,26 +118,35 @@ uint get_image_size_for_bmp(FILE *fptr_image)
  */
 Status open_files(EncodeInfo *encInfo)
 {
+    // Files already handed in by the caller (e.g. daemon fd passing) are used as is
     // Src Image file
-    encInfo->fptr_src_image = fopen(encInfo->src_image_fname, "rb");
+    if (encInfo->fptr_src_image == NULL)
+        encInfo->fptr_src_image = fopen(encInfo->src_image_fname, "rb");
     // Do Error handling
     if (encInfo->fptr_src_image == NULL)
     {
     	fprintf(stderr, "ERROR: No Source file found with name \"%s\"\n", encInfo->src_image_fname);
     	return e_failure;
     }
+    set_job_buffer(encInfo->fptr_src_image, &encInfo->context, JOB_BUFFER_SRC);
 
-    // Secret file
-    encInfo->fptr_secret = fopen(encInfo->secret_fname, "rb");
+    // Secret file, not needed when the caller already holds its data
+    if (encInfo->fptr_secret == NULL && encInfo->payload == NULL)
+        encInfo->fptr_secret = fopen(encInfo->secret_fname, "rb");
     // Do Error handling
-    if (encInfo->fptr_secret == NULL)
+    if (encInfo->fptr_secret == NULL && encInfo->payload == NULL)
     {
     	fprintf(stderr, "ERROR: No Secrat file found with name \"%s\"\n", encInfo->secret_fname);
     	return e_failure;
     }
+    set_job_buffer(encInfo->fptr_secret, &encInfo->context, JOB_BUFFER_SECRET);
 
-    // Stego Image file
-    encInfo->fptr_stego_image = fopen(encInfo->stego_image_fname, "wb");
+    // Stego Image file, readable too when its digest is checked, it is cached afterwards or mapped.
+    // Written under a temp name and renamed at the end, so an older output is only
+    // ever replaced whole, never truncated
+    if (encInfo->fptr_stego_image == NULL)
+        encInfo->fptr_stego_image = open_temp_output(encInfo->stego_image_fname, encInfo->stego_temp_fname, sizeof(encInfo->stego_temp_fname),
+                                                     (encInfo->verify >= VERIFY_DIGEST || encInfo->cache_dir || encInfo->map_threads) ? "w+b" : "wb");
     // Do Error handling
     if (encInfo->fptr_stego_image == NULL)
     {
@@ -96,6 +154,7 @@ Status open_files(EncodeInfo *encInfo)
     	fprintf(stderr, "ERROR: Unable to Create output file with name \"%s\"\n", encInfo->stego_image_fname);
     	return e_failure;
     }
+    set_job_buffer(encInfo->fptr_stego_image, &encInfo->context, JOB_BUFFER_STEGO);
     printf("Output File Created Successfully with Name \"%s\"\n", encInfo->stego_image_fname);
     // No failure return e_success
     return e_success;
@@ -109,6 +168,21 @@ OperationType check_operation_type(char *argv[])
     // -d for decoding
     if(strcmp(argv[1], "-d") == 0) 
         return e_decode;
+    // -s for serving jobs over a unix socket
+    if(strcmp(argv[1], "-s") == 0)
+        return e_daemon;
+    // -S for splitting a secret across several covers
+    if(strcmp(argv[1], "-S") == 0)
+        return e_shard_encode;
+    // -R for rebuilding a secret from its shards
+    if(strcmp(argv[1], "-R") == 0)
+        return e_shard_decode;
+    // -F for copying one secret into several covers, a key each
+    if(strcmp(argv[1], "-F") == 0)
+        return e_fanout_encode;
+    // -b for timing the pixel format kernels
+    if(strcmp(argv[1], "-b") == 0)
+        return e_benchmark;
     fprintf(stderr, "Error: Invalid Operation => %s\n", argv[1]);
     return e_unsupported;
 }
@@ -116,11 +190,11 @@ OperationType check_operation_type(char *argv[])
 Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo)
 {
     // If argv[2] is .bmp file
-    encInfo->src_image_fname = malloc(50);
     char *ext = strstr(argv[2], ".bmp");
     if (ext != NULL && strcmp(ext, ".bmp") == 0)
     {
-        strcpy(encInfo->src_image_fname, argv[2]);
+        if(copy_file_name(encInfo->src_image_fname, argv[2]) == e_failure)
+            return e_failure;
     }
     else
     {
@@ -134,8 +208,8 @@ Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo)
         fprintf(stderr, "Error: No file extension found in secret file name : \"%s\"\nRecommended File extension : \".txt\" or \".jpg\" or \".c\" or \".sh\"\n", argv[3]);
             return e_failure;
     }
-    encInfo->secret_fname = malloc(50);
-    strcpy(encInfo->secret_fname, argv[3]);
+    if(copy_file_name(encInfo->secret_fname, argv[3]) == e_failure)
+        return e_failure;
     if (strcmp(ext, ".c") == 0)
         strcpy(encInfo->extn_secret_file, ".c");
     else if (strcmp(ext, ".sh") == 0)
@@ -150,7 +224,6 @@ Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo)
         return e_failure;
     }
     // If argv[4] is present or not
-    encInfo->stego_image_fname = malloc(50);
     if(argv[4] == NULL)
     {
         // Creating default file name argv[4] is not present
@@ -159,8 +232,12 @@ Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo)
     else
     {
         // If argv[4] is .bmp file 
-        if(strcmp(strstr(argv[4], ".bmp"), ".bmp") == 0)
-            strcpy(encInfo->stego_image_fname, argv[4]);
+        ext = strstr(argv[4], ".bmp");
+        if(ext != NULL && strcmp(ext, ".bmp") == 0)
+        {
+            if(copy_file_name(encInfo->stego_image_fname, argv[4]) == e_failure)
+                return e_failure;
+        }
         else
         {
             fprintf(stderr, "Error: Destination_Image Should be \".bmp\" File\n");
@@ -170,81 +247,209 @@ Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo)
     return e_success;
 }
 
-Status do_encoding(EncodeInfo *encInfo)
+Status copy_file_name(char *fname, const char *name)
 {
-    if(open_files(encInfo) == e_success)
+    // Name buffers are part of the job, a longer name is refused rather than truncated
+    if(strlen(name) >= MAX_FNAME)
     {
-        // Checking the Image and secret file capacity is valid or not
-        if(check_capacity(encInfo) == e_failure)
-        {
-            fprintf(stderr, "Error: File Size is incompatible to encode\n");
-            return e_failure;
-        }
-        if(copy_bmp_header(encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_failure) 
-            return e_failure;
+        fprintf(stderr, "Error: File name \"%s\" is longer than %d characters\n", name, MAX_FNAME - 1);
+        return e_failure;
+    }
+    strcpy(fname, name);
+    return e_success;
+}
 
-        // Taking magic string from user to match with the encoded magic string
-        char *magic_string = malloc(50);
-        printf("Enter the Magic string keys : ");
-        scanf(" %s", magic_string);
-        if(encode_magic_string(magic_string, encInfo) == e_failure) return e_failure;
-        if(encode_secret_file_extn_size(strlen(encInfo->extn_secret_file), encInfo) == e_failure) return e_failure;
-        if(encode_secret_file_extn(encInfo->extn_secret_file, encInfo) == e_failure) return e_failure;
-        if(encode_secret_file_size(encInfo->secret_size, encInfo) == e_failure) return e_failure;
-        if(encode_secret_file_data(encInfo) == e_failure) return e_failure;
-        if(copy_remaining_img_data(encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_failure) return e_failure;
-        // Freeing allocated memory for magic string
-        free(magic_string);
+Status do_encoding(EncodeInfo *encInfo)
+{
+    Status ret = e_failure;
+    // Without pool buffers the files fall back to stdio's own
+    acquire_job_context(&encInfo->context);
+    // Whole secret jobs can be served from, and go into, the result cache
+    if(encInfo->cache_dir && encInfo->shard_count == 0)
+        ret = do_cached_encoding(encInfo);
+    else if(open_files(encInfo) == e_success)
+        ret = encode_stego_image(encInfo);
+
+    // closing the open files, also on failure so long running callers don't leak them
+    unmap_stego_images(encInfo);
+    if(ret == e_success && encInfo->stego_temp_fname[0] && fflush(encInfo->fptr_stego_image) != 0)
+    {
+        perror("fflush");
+        ret = e_failure;
     }
-    else
-        return e_failure; 
+    close_files(encInfo);
+    // A finished output replaces the old one in one step, anything else is removed
+    ret = commit_temp_output(encInfo->stego_temp_fname, encInfo->stego_image_fname, ret);
+    finish_job_progress(&encInfo->progress, ret);
+    // The buffers go back only once no FILE uses them
+    release_job_context(&encInfo->context);
+    print_job_allocations(&encInfo->context);
+    if(ret == e_success)
+        printf("Encoding Completed Successfully\n");
+    return ret;
+}
 
+Status encode_stego_image(EncodeInfo *encInfo)
+{
+    // Taking magic string from user to match with the encoded magic string
+    if(encInfo->magic_string[0] == '\0' && prompt_magic_string(encInfo) == e_failure)
+        return e_failure;
+    // Pixel format decides which bytes carry the data
+    if(get_bmp_format(encInfo->fptr_src_image, &encInfo->format, &encInfo->pixel_offset) == e_failure)
+        return e_failure;
+    // Checking the Image and secret file capacity is valid or not
+    if(check_capacity(encInfo) == e_failure)
+    {
+        fprintf(stderr, "Error: File Size is incompatible to encode\n");
+        return e_failure;
+    }
+    encInfo->digest = DIGEST_OFFSET_BASIS;
+    encInfo->verified = 0;
+    memset(&encInfo->changes, 0, sizeof(encInfo->changes));
+    // Progress is the output written, the whole cover's size in the end
+    start_job_progress(&encInfo->progress, encInfo->stego_image_fname, get_file_size(encInfo->fptr_src_image));
+    // Mapped output, or stdio when either file cannot be mapped (pipes, write only fds)
+    if(encInfo->map_threads)
+    {
+        if(map_stego_images(encInfo) == e_success)
+            printf("Images of %" PRIu64 " bytes mapped Successfully\n", encInfo->map_size);
+        else
+            printf("Images cannot be mapped, writing through stdio\n");
+    }
+    if(copy_bmp_header(encInfo) == e_failure) 
+        return e_failure;
+    // Setup is done, nothing from here to the last block should allocate
+    mark_job_data_pass(&encInfo->context);
 
+    if(encInfo->shard_count)
+        encInfo->flags |= STEGO_FLAG_SHARD;
+    if(encInfo->fec_parity)
+        encInfo->flags |= STEGO_FLAG_FEC;
+    if(encInfo->matrix_k)
+        encInfo->flags |= STEGO_FLAG_MATRIX;
+    if(encode_magic_string(encInfo->magic_string, encInfo) == e_failure) return e_failure;
+    if(encode_header_flags(encInfo->flags, encInfo) == e_failure) return e_failure;
+    if(encode_secret_file_extn_size(strlen(encInfo->extn_secret_file), encInfo) == e_failure) return e_failure;
+    if(encode_secret_file_extn(encInfo->extn_secret_file, encInfo) == e_failure) return e_failure;
+    if(encode_secret_file_size(encInfo->secret_size, encInfo) == e_failure) return e_failure;
+    if((encInfo->flags & STEGO_FLAG_SHARD) && encode_shard_header(encInfo) == e_failure) return e_failure;
+    if((encInfo->flags & STEGO_FLAG_FEC) && encode_fec_header(encInfo) == e_failure) return e_failure;
+    if((encInfo->flags & STEGO_FLAG_MATRIX) && encode_matrix_header(encInfo) == e_failure) return e_failure;
+    if(encode_secret_file_data(encInfo) == e_failure) return e_failure;
+    if(copy_remaining_img_data(encInfo) == e_failure) return e_failure;
+    if(encInfo->stego_map && sync_stego_map(encInfo) == e_failure) return e_failure;
+    // Counted by the kernels on the way, so the report needs no second look at either image
+    DistortionMetrics metrics;
+    if(get_distortion_metrics(encInfo->format, &encInfo->changes, get_bmp_pixel_count(encInfo->fptr_src_image), &metrics) == e_success)
+        print_distortion_metrics(encInfo->format, &metrics);
+    if(encInfo->verify)
+        printf("Verified %" PRIu64 " payload bytes Successfully\n", encInfo->verified);
+    if(encInfo->verify >= VERIFY_DIGEST && verify_stego_digest(encInfo) == e_failure) return e_failure;
+    return e_success;
+}
 
-    // Freeing the allocated memory for file name
-    free(encInfo->src_image_fname);
-    free(encInfo->secret_fname);
-    free(encInfo->stego_image_fname);
-    // closing the open files
-    fclose(encInfo->fptr_src_image);
-    fclose(encInfo->fptr_secret);
-    fclose(encInfo->fptr_stego_image);
-    printf("Encoding Completed Successfully\n");
+Status prompt_magic_string(EncodeInfo *encInfo)
+{
+    printf("Enter the Magic string keys : ");
+    if(scanf(" %49s", encInfo->magic_string) != 1)
+        return e_failure;
     return e_success;
 }
 
+void close_files(EncodeInfo *encInfo)
+{
+    if(encInfo->fptr_src_image)
+        fclose(encInfo->fptr_src_image);
+    if(encInfo->fptr_secret)
+        fclose(encInfo->fptr_secret);
+    if(encInfo->fptr_stego_image)
+        fclose(encInfo->fptr_stego_image);
+    encInfo->fptr_src_image = encInfo->fptr_secret = encInfo->fptr_stego_image = NULL;
+}
+
 Status check_capacity(EncodeInfo *encInfo)
 {
-    encInfo->secret_size = get_file_size(encInfo->fptr_secret);
-    if(get_image_size_for_bmp(encInfo->fptr_src_image) < 54 + 8 * (strlen(MAGIC_STRING) + 8 + strlen(encInfo->extn_secret_file) + encInfo->secret_size))
+    // A prepared payload comes with its secret_size, a shard carries the slice
+    // planned by the caller, otherwise the whole file
+    if(encInfo->payload == NULL)
+    {
+        uint64_t file_size = get_file_size(encInfo->fptr_secret);
+        if(encInfo->shard_count == 0)
+            encInfo->secret_size = file_size;
+        else if(encInfo->secret_offset > file_size || file_size - encInfo->secret_offset < encInfo->secret_size)
+            return e_failure;
+    }
+    encInfo->image_capacity = get_image_size_for_bmp(encInfo->fptr_src_image);
+    // Every payload byte takes one group of image bytes
+    uint64_t payload_capacity = encInfo->image_capacity / encInfo->format->group_size;
+    uint64_t needed = get_header_size(encInfo);
+    // Parity bytes travel with the data when FEC is on
+    uint64_t data_size = encInfo->secret_size;
+    if(encInfo->fec_parity)
+    {
+        if(encInfo->fec_parity < MIN_FEC_PARITY || encInfo->fec_parity > MAX_FEC_PARITY)
+            return e_failure;
+        data_size = get_fec_encoded_size(data_size, encInfo->fec_parity);
+    }
+    // Matrix embedding spreads every k bits over 2^k carriers
+    if(encInfo->matrix_k)
+    {
+        if(encInfo->matrix_k < MIN_MATRIX_K || encInfo->matrix_k > MAX_MATRIX_K)
+            return e_failure;
+        data_size = get_matrix_carrier_size(data_size, encInfo->matrix_k);
+    }
+    // Checked this way round so a huge secret_size cannot wrap the sum
+    if(payload_capacity < needed || payload_capacity - needed < data_size)
         return e_failure;
     return e_success;
 }
 
-uint get_file_size(FILE *fptr)
+uint64_t get_header_size(EncodeInfo *encInfo)
+{
+    uint64_t magic_len = encInfo->magic_string[0] ? strlen(encInfo->magic_string) : strlen(MAGIC_STRING);
+    // Header fields: magic, 32 bit flags, 32 bit extn size, extn, 64 bit secret size
+    uint64_t size = magic_len + 4 + 4 + strlen(encInfo->extn_secret_file) + 8;
+    if(encInfo->shard_count)
+        size += SHARD_HEADER_SIZE;
+    if(encInfo->fec_parity)
+        size += FEC_HEADER_SIZE;
+    if(encInfo->matrix_k)
+        size += MATRIX_HEADER_SIZE;
+    return size;
+}
+
+uint64_t get_file_size(FILE *fptr)
 {
     // set the file pointer to end
-    fseek(fptr, 0, SEEK_END);
-    return ftell(fptr);
+    fseeko(fptr, 0, SEEK_END);
+    return (uint64_t)ftello(fptr);
 }
 
-Status copy_bmp_header(FILE *fptr_src_image, FILE *fptr_dest_image)
+Status copy_bmp_header(EncodeInfo *encInfo)
 {
-    // Creating a buffer to store header
-    unsigned char header[54];
+    // Creating a buffer to store header, copied in pieces as the
+    // palette or channel masks make it longer than 54 bytes
+    unsigned char header[MAX_CHUNK_SIZE];
+    uint header_size = encInfo->pixel_offset;
     // Setting the file pointer to beginning
-    fseek(fptr_src_image, 0, SEEK_SET);
-    // Reading the BMP header
-    if(fread(header, 54, 1, fptr_src_image) != 1)
-    {
-        fprintf(stderr, "Error: Failed to read Header\n");
-        return e_failure;
-    }
-    // Writing the BMP header 
-    if(fwrite(header, 54, 1, fptr_dest_image) != 1)
+    fseek(encInfo->fptr_src_image, 0, SEEK_SET);
+    while(header_size > 0)
     {
-        fprintf(stderr, "Error: Failed to write Header\n");
-        return e_failure;
+        uint len = header_size < MAX_CHUNK_SIZE ? header_size : MAX_CHUNK_SIZE;
+        // Reading the BMP header
+        unsigned char *block = read_image_block(header, len, encInfo);
+        if(block == NULL)
+        {
+            fprintf(stderr, "Error: Failed to read Header\n");
+            return e_failure;
+        }
+        // Writing the BMP header 
+        if(write_stego_data(block, len, encInfo) == e_failure)
+        {
+            fprintf(stderr, "Error: Failed to write Header\n");
+            return e_failure;
+        }
+        header_size -= len;
     }
     printf("Header Copied Successfully\n");
     return e_success;
@@ -252,7 +457,7 @@ Status copy_bmp_header(FILE *fptr_src_image, FILE *fptr_dest_image)
 
 Status encode_magic_string(char *magic_string, EncodeInfo *encInfo)
 {
-    if(encode_data_to_image(magic_string, strlen(magic_string), encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_failure)
+    if(encode_data_to_image(magic_string, strlen(magic_string), encInfo) == e_failure)
     {
         fprintf(stderr, "Error: Failed to encode Magic String\n");
         return e_failure;
@@ -261,41 +466,127 @@ Status encode_magic_string(char *magic_string, EncodeInfo *encInfo)
     return e_success;
 }
 
-Status encode_data_to_image(char *data, int size, FILE *fptr_src_image, FILE *fptr_stego_image)
+Status encode_header_flags(uint flags, EncodeInfo *encInfo)
 {
-    // Creating buffer for each 8 bits
-    unsigned char image_buffer[MAX_IMAGE_BUF_SIZE];
-    if (!data || !fptr_src_image || !fptr_stego_image)
+    // The layout version rides in the top byte, the first field older images have there is small
+    if(encode_int_to_lsb(flags | (uint)STEGO_HEADER_VERSION << STEGO_VERSION_SHIFT, encInfo) == e_failure)
+    {
+        fprintf(stderr, "Error: Failed to encode Header Flags\n");
         return e_failure;
-    
-    for(int i = 0; i < size; i++)
+    }
+    return e_success;
+}
+
+Status encode_shard_header(EncodeInfo *encInfo)
+{
+    // payload id, shard index and shard count, 32 bits each
+    if(encode_int_to_lsb(encInfo->payload_id, encInfo) == e_failure ||
+       encode_int_to_lsb(encInfo->shard_index, encInfo) == e_failure ||
+       encode_int_to_lsb(encInfo->shard_count, encInfo) == e_failure)
     {
-        // Reading 8 bytes from the src image
-        if(fread(image_buffer, MAX_IMAGE_BUF_SIZE, 1, fptr_src_image) != 1)
-            return e_failure;
-        // Encoding the 1 byte data into the 8 bytes
-        if(encode_byte_to_lsb(data[i], image_buffer) == e_failure)
+        fprintf(stderr, "Error: Failed to encode Shard Header\n");
+        return e_failure;
+    }
+    printf("Shard %u of %u (payload %08x) Encoded Successfully\n", encInfo->shard_index + 1, encInfo->shard_count, encInfo->payload_id);
+    return e_success;
+}
+
+Status encode_fec_header(EncodeInfo *encInfo)
+{
+    if(encode_int_to_lsb(encInfo->fec_parity, encInfo) == e_failure)
+    {
+        fprintf(stderr, "Error: Failed to encode FEC Header\n");
+        return e_failure;
+    }
+    printf("FEC with %u parity bytes per codeword Encoded Successfully\n", encInfo->fec_parity);
+    return e_success;
+}
+
+Status encode_matrix_header(EncodeInfo *encInfo)
+{
+    if(encode_int_to_lsb(encInfo->matrix_k, encInfo) == e_failure)
+    {
+        fprintf(stderr, "Error: Failed to encode Matrix Header\n");
+        return e_failure;
+    }
+    printf("Matrix Embedding with %u bits per unit Encoded Successfully\n", encInfo->matrix_k);
+    return e_success;
+}
+
+Status encode_data_to_image(const char *data, uint64_t size, EncodeInfo *encInfo)
+{
+    // Block buffer holding whole groups of image bytes, and the bytes read back out of it
+    unsigned char image_buffer[MAX_CHUNK_SIZE];
+    unsigned char check[MAX_BLOCK_CARRIERS];
+    const BmpFormat *format = encInfo->format;
+    if (!data || !encInfo->fptr_src_image || !encInfo->fptr_stego_image || !format)
+        return e_failure;
+
+    uint64_t per_block = MAX_CHUNK_SIZE / format->group_size;
+    while(size > 0)
+    {
+        size_t count = size < per_block ? size : per_block;
+        size_t len = count * format->group_size;
+        // Reading one block from the src image
+        unsigned char *block = read_image_block(image_buffer, len, encInfo);
+        if(block == NULL)
             return e_failure;
-        // Writing the 8 bytes to the stego image
-        if(fwrite(image_buffer, MAX_IMAGE_BUF_SIZE, 1, fptr_stego_image) != 1)
+        // Encoding count data bytes with the format's kernel
+        format->embed(block, (const unsigned char *)data, count, &encInfo->changes);
+        // Reading the span back while the block is still in cache
+        if(encInfo->verify)
+        {
+            format->extract(block, check, count);
+            if(memcmp(check, data, count) != 0)
+            {
+                fprintf(stderr, "Error: Verify failed, payload bytes %" PRIu64 " to %" PRIu64 " do not read back\n", encInfo->verified, encInfo->verified + count);
+                return e_failure;
+            }
+            encInfo->verified += count;
+        }
+        // Writing the block to the stego image
+        if(write_stego_data(block, len, encInfo) == e_failure)
             return e_failure;
+        data += count;
+        size -= count;
     }
     return e_success;
 }
 
-Status encode_byte_to_lsb(char data,  char *image_buffer)
+Status encode_matrix_data_to_image(const char *data, uint64_t size, EncodeInfo *encInfo)
 {
-    // Checking if the buffer is NULL
-    if(image_buffer == NULL)
+    // Block buffer holding whole units, and the carrier bits pulled out of it
+    unsigned char image_buffer[MAX_CHUNK_SIZE];
+    unsigned char plane[MAX_BLOCK_CARRIERS];
+    const BmpFormat *format = encInfo->format;
+    MatrixCode *code = &encInfo->matrix;
+    if (!data || !encInfo->fptr_src_image || !encInfo->fptr_stego_image || !format)
         return e_failure;
-    for(int j = 0 ; j < MAX_IMAGE_BUF_SIZE; j++)
+
+    // Only whole units go out, leftover bits wait for the next call or the final padded unit
+    uint64_t units = size ? (code->acc_bits + size * 8) / code->k : (code->acc_bits ? 1 : 0);
+    uint64_t per_block = MAX_CHUNK_SIZE / (code->unit_bytes * format->group_size);
+    while(units > 0)
     {
-        // Clearing the LSB bit from te buffer
-        image_buffer[j] = image_buffer[j] & ~1; 
-        // Getting the nth bit from the data
-        int mask = (data >> (7 - j)) & 1;
-        // Setting the nth bit from the data into the LSB of buffer
-        image_buffer[j] = image_buffer[j] | mask;
+        size_t count = units < per_block ? units : per_block;
+        size_t carriers = count * code->unit_bytes;
+        size_t len = carriers * format->group_size;
+        // Reading one block from the src image
+        unsigned char *block = read_image_block(image_buffer, len, encInfo);
+        if(block == NULL)
+            return e_failure;
+        // Carrier bits out, at most one flipped per unit, back in
+        format->extract(block, plane, carriers);
+        size_t used = embed_matrix_units(code, plane, count, (const unsigned char *)data, size);
+        format->embed(block, plane, carriers, &encInfo->changes);
+        if(encInfo->verify && verify_matrix_block(block, count, data, used, encInfo) == e_failure)
+            return e_failure;
+        // Writing the block to the stego image
+        if(write_stego_data(block, len, encInfo) == e_failure)
+            return e_failure;
+        data += used;
+        size -= used;
+        units -= count;
     }
     return e_success;
 }
@@ -303,7 +594,7 @@ Status encode_byte_to_lsb(char data,  char *image_buffer)
 Status encode_secret_file_extn_size(uint file_extn_size, EncodeInfo *encInfo)
 {
     // Calling the encode data fns to encode file ext size
-    if(encode_int_to_lsb(file_extn_size, encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_failure)
+    if(encode_int_to_lsb(file_extn_size, encInfo) == e_failure)
     {
         fprintf(stderr, "Error: Failed to encode File extension Size\n");
         return e_failure;
@@ -315,7 +606,7 @@ Status encode_secret_file_extn_size(uint file_extn_size, EncodeInfo *encInfo)
 Status encode_secret_file_extn(char *file_extn, EncodeInfo *encInfo)
 {
     // Calling the enocode data fns to encode secret file ext
-    if(encode_data_to_image(file_extn, strlen(file_extn), encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_failure)
+    if(encode_data_to_image(file_extn, strlen(file_extn), encInfo) == e_failure)
     {
         fprintf(stderr, "Error: Failed to encode File extension Name\n");
         return e_failure;
@@ -324,68 +615,250 @@ Status encode_secret_file_extn(char *file_extn, EncodeInfo *encInfo)
     return e_success;
 }
 
-Status encode_secret_file_size(long file_size, EncodeInfo *encInfo)
+Status encode_secret_file_size(uint64_t file_size, EncodeInfo *encInfo)
 {
     // Calling the encode data fns to encode secret file size
-    uint size = file_size;
-    if(encode_int_to_lsb(size, encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_failure)
+    if(encode_long_to_lsb(file_size, encInfo) == e_failure)
     {
         fprintf(stderr, "Error: Failed to encode Secret File Size\n");
         return e_failure;
     } 
-    printf("Secret File Size %d Encoded Successfully\n", size);
+    printf("Secret File Size %" PRIu64 " Encoded Successfully\n", file_size);
     return e_success;
 }
 
 Status encode_secret_file_data(EncodeInfo *encInfo)
 {
-    // creating buffer character pass copy one by one character
-    unsigned char secret_data[encInfo->secret_size];
-    rewind(encInfo->fptr_secret);
-    // Reading 1 byte from the secret file one by one 
-    if(fread(secret_data, encInfo->secret_size, 1, encInfo->fptr_secret) != 1)
+    // creating a fixed size buffer, the secret is streamed chunk by chunk
+    // so its size is not limited by the stack
+    char secret_data[MAX_CHUNK_SIZE];
+    // A prepared payload is already FEC coded, it is embedded as it stands
+    uint64_t remaining = encInfo->payload ? encInfo->payload_size : encInfo->secret_size;
+    size_t chunk_limit = MAX_CHUNK_SIZE;
+    // With FEC a chunk is a whole number of codewords, plus room for their parity
+    unsigned char coded_data[FEC_BLOCKS_PER_CHUNK * FEC_BLOCK_SIZE];
+    const FecCodec *codec = NULL;
+    if(encInfo->fec_parity && encInfo->payload == NULL)
     {
-        fprintf(stderr, "Error:failed to read secret file data\n");
-        return e_failure;
+        if((codec = get_fec_codec(encInfo->fec_parity)) == NULL)
+            return e_failure;
+        chunk_limit = FEC_BLOCKS_PER_CHUNK * (FEC_BLOCK_SIZE - encInfo->fec_parity);
     }
-    // Calling the encode data fns to encode each character 
-    if (encode_data_to_image(secret_data, encInfo->secret_size, encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_failure)
+    if(encInfo->matrix_k)
     {
-        fprintf(stderr, "Error: Failed to encode Secret File data\n");
-        return e_failure;
+        if(init_matrix(&encInfo->matrix, encInfo->matrix_k) == e_failure)
+            return e_failure;
+        // The read back runs its own decoder over the same units
+        init_matrix(&encInfo->verify_matrix, encInfo->matrix_k);
+        encInfo->verify_lag = 0;
+    }
+    // Starting at this shard's slice (offset 0 for a whole secret)
+    if(encInfo->payload == NULL)
+        fseeko(encInfo->fptr_secret, encInfo->secret_offset, SEEK_SET);
+    while(remaining > 0)
+    {
+        size_t chunk = remaining < chunk_limit ? remaining : chunk_limit;
+        const char *data = secret_data;
+        size_t len = chunk;
+        if(encInfo->payload)
+            data = (const char *)encInfo->payload + (encInfo->payload_size - remaining);
+        // Reading the next chunk from the secret file
+        else if(fread(secret_data, chunk, 1, encInfo->fptr_secret) != 1)
+        {
+            fprintf(stderr, "Error:failed to read secret file data\n");
+            return e_failure;
+        }
+        else if(encInfo->fec_parity)
+        {
+            len = encode_fec_chunk(codec, (unsigned char *)secret_data, chunk, coded_data);
+            data = (const char *)coded_data;
+        }
+        // Calling the encode data fns to encode each character 
+        Status ret = encInfo->matrix_k ? encode_matrix_data_to_image(data, len, encInfo) : encode_data_to_image(data, len, encInfo);
+        if (ret == e_failure)
+        {
+            fprintf(stderr, "Error: Failed to encode Secret File data\n");
+            return e_failure;
+        }
+        remaining -= chunk;
+    }
+    if(encInfo->matrix_k)
+    {
+        // The bits left over from the last chunk fill one more unit
+        if(encode_matrix_data_to_image(secret_data, 0, encInfo) == e_failure)
+        {
+            fprintf(stderr, "Error: Failed to encode Secret File data\n");
+            return e_failure;
+        }
+        // Same payload bytes as plain LSB would carry, FEC parity included
+        uint64_t payload = encInfo->fec_parity ? get_fec_encoded_size(encInfo->secret_size, encInfo->fec_parity) : encInfo->secret_size;
+        double per_byte = payload ? (double)encInfo->matrix.changed / payload : 0;
+        double plain_per_byte = payload ? (double)encInfo->matrix.plain_changed / payload : 0;
+        printf("Matrix Embedding changed %" PRIu64 " cover bytes (%.2f per payload byte), plain LSB %" PRIu64 " (%.2f per payload byte)\n",
+               encInfo->matrix.changed, per_byte, encInfo->matrix.plain_changed, plain_per_byte);
     }
     printf("Secret File Data Encoded Successfully\n");
     return e_success;
 }
 
-Status copy_remaining_img_data(FILE *fptr_src, FILE *fptr_dest)
+Status copy_remaining_img_data(EncodeInfo *encInfo)
 {
-    unsigned char ch;
-    // Reading character from the src image file one by one
-    while(fread(&ch, 1, 1, fptr_src) == 1)
+    unsigned char buffer[MAX_CHUNK_SIZE];
+    size_t len;
+    // Mapped, the tail is one parallel copy between the mappings
+    if(encInfo->stego_map)
+    {
+        uint64_t pos = encInfo->map_pos;
+        if(copy_mapped_tail(encInfo) == e_failure)
+        {
+            fprintf(stderr, "Error: Failed to Copy Remaining Source Image Data\n");
+            return e_failure;
+        }
+        // Hashed from the cover, what the tail should be, as the stdio path hashes
+        // its source buffer; the output's own pages would always match the read back
+        if(encInfo->verify >= VERIFY_DIGEST)
+            encInfo->digest = update_digest(encInfo->digest, encInfo->src_map + pos, encInfo->map_size - pos);
+        return update_job_progress(&encInfo->progress, encInfo->map_size - pos);
+    }
+    // Reading the src image file chunk by chunk
+    while((len = fread(buffer, 1, MAX_CHUNK_SIZE, encInfo->fptr_src_image)) > 0)
     {
-        // Writing the charcter into the des image file one by one
-        if(fwrite(&ch, 1, 1, fptr_dest) != 1)
+        // Writing the chunk into the des image file
+        if(write_stego_data(buffer, len, encInfo) == e_failure)
         {
             fprintf(stderr, "Error: Failed to Copy Remaining Source Image Data\n");
             return e_failure;
         }
     }
+    if(ferror(encInfo->fptr_src_image))
+    {
+        fprintf(stderr, "Error: Failed to Read Remaining Source Image Data\n");
+        return e_failure;
+    }
     printf("Remaining Data copied Successfully\n");
     return e_success;
 }
 
-Status encode_int_to_lsb(uint size, FILE *fptr_src_image, FILE *fptr_stego_image)
+unsigned char *read_image_block(unsigned char *buffer, size_t len, EncodeInfo *encInfo)
 {
-    char buffer[32];
-    for(int i = 0; i < 32; i++)
+    // Mapped, the block is copied into place in the output and embedded there
+    if(encInfo->stego_map)
     {
-        if(fread(&buffer[i], 1, 1, fptr_src_image) != 1)
-            return e_failure;
-        buffer[i] = (buffer[i] & ~1) | ((size >> (31 - i)) & 1); 
+        if(len > encInfo->map_size - encInfo->map_pos)
+            return NULL;
+        unsigned char *block = encInfo->stego_map + encInfo->map_pos;
+        memcpy(block, encInfo->src_map + encInfo->map_pos, len);
+        return block;
+    }
+    if(fread(buffer, len, 1, encInfo->fptr_src_image) != 1)
+        return NULL;
+    return buffer;
+}
 
-        if(fwrite(&buffer[i], 1, 1, fptr_stego_image) != 1)
+Status write_stego_data(const void *data, size_t len, EncodeInfo *encInfo)
+{
+    // Mapped, a block from read_image_block() is already in place
+    if(encInfo->stego_map)
+    {
+        if(len > encInfo->map_size - encInfo->map_pos)
             return e_failure;
+        if(data != encInfo->stego_map + encInfo->map_pos)
+            memcpy(encInfo->stego_map + encInfo->map_pos, data, len);
+        encInfo->map_pos += len;
+    }
+    else if(fwrite(data, len, 1, encInfo->fptr_stego_image) != 1)
+        return e_failure;
+    // A block boundary, the only place a job reports and notices it was cancelled
+    if(update_job_progress(&encInfo->progress, len) == e_failure)
+        return e_failure;
+    // Digest of what we meant to write, the file is matched against it at the end
+    if(encInfo->verify >= VERIFY_DIGEST)
+        encInfo->digest = update_digest(encInfo->digest, data, len);
+    return e_success;
+}
+
+Status verify_matrix_block(const unsigned char *image, size_t units, const char *data, size_t used, EncodeInfo *encInfo)
+{
+    unsigned char plane[MAX_BLOCK_CARRIERS];
+    unsigned char check[MAX_BLOCK_CARRIERS];
+    MatrixCode *code = &encInfo->verify_matrix;
+    size_t carriers = units * code->unit_bytes;
+
+    // Decoding exactly as -d would, every byte whose bits are all in
+    // finished units comes out: the one held back from the previous
+    // block (its last bits were in this one) and then this block's bytes
+    encInfo->format->extract(image, plane, carriers);
+    size_t out = extract_matrix_units(code, plane, units, check, sizeof(check));
+    size_t lag = encInfo->verify_lag;
+    if(out > lag + used || out + 1 < lag + used ||
+       (lag && out && check[0] != encInfo->verify_held) ||
+       (out > lag && memcmp(check + lag, data, out - lag) != 0))
+    {
+        fprintf(stderr, "Error: Verify failed, matrix embedded payload bytes from %" PRIu64 " do not read back\n", encInfo->verified);
+        return e_failure;
+    }
+    // At most one byte is waiting on the next block's units
+    if(lag + used > out)
+    {
+        encInfo->verify_held = used ? data[used - 1] : encInfo->verify_held;
+        encInfo->verify_lag = 1;
+    }
+    else
+        encInfo->verify_lag = 0;
+    encInfo->verified += out;
+    return e_success;
+}
+
+Status verify_stego_digest(EncodeInfo *encInfo)
+{
+    unsigned char buffer[MAX_CHUNK_SIZE];
+    uint64_t digest = DIGEST_OFFSET_BASIS;
+    off_t offset = 0, end;
+    ssize_t len;
+
+    // Everything is still in the page cache, pread() does not move the FILE position
+    if(encInfo->stego_map)
+        end = encInfo->map_size;
+    else if(fflush(encInfo->fptr_stego_image) != 0 || (end = ftello(encInfo->fptr_stego_image)) < 0)
+    {
+        fprintf(stderr, "Error: Failed to flush \"%s\" for the digest check\n", encInfo->stego_image_fname);
+        return e_failure;
+    }
+    int fd = fileno(encInfo->fptr_stego_image);
+    while(offset < end && (len = pread(fd, buffer, end - offset < MAX_CHUNK_SIZE ? end - offset : MAX_CHUNK_SIZE, offset)) > 0)
+    {
+        digest = update_digest(digest, buffer, len);
+        offset += len;
+    }
+    if(offset != end)
+    {
+        perror("pread");
+        fprintf(stderr, "Error: Unable to read back \"%s\" for the digest check\n", encInfo->stego_image_fname);
+        return e_failure;
     }
+    if(digest != encInfo->digest)
+    {
+        fprintf(stderr, "Error: Verify failed, \"%s\" digest %016" PRIx64 " does not match the written data %016" PRIx64 "\n", encInfo->stego_image_fname, digest, encInfo->digest);
+        return e_failure;
+    }
+    printf("Output Digest %016" PRIx64 " Verified Successfully\n", digest);
     return e_success;
-}
\ No newline at end of file
+}
+
+Status encode_int_to_lsb(uint size, EncodeInfo *encInfo)
+{
+    // Most significant byte first, so the bits go out MSB first
+    char buffer[4];
+    for(int i = 0; i < 4; i++)
+        buffer[i] = size >> (24 - 8 * i);
+    return encode_data_to_image(buffer, 4, encInfo);
+}
+
+Status encode_long_to_lsb(uint64_t size, EncodeInfo *encInfo)
+{
+    // Most significant byte first, same as encode_int_to_lsb()
+    char buffer[8];
+    for(int i = 0; i < 8; i++)
+        buffer[i] = size >> (56 - 8 * i);
+    return encode_data_to_image(buffer, 8, encInfo);
+}
@@ -10,21 +10,35 @@
  *                Functions:
  *                - check_operation_type()
  *                - read_and_validate_encode_args()
+ *                - copy_file_name()
  *                - do_encoding()
+ *                - encode_stego_image()
+ *                - prompt_magic_string()
+ *                - close_files()
  *                - open_files()
  *                - check_capacity()
+ *                - get_header_size()
  *                - get_image_size_for_bmp()
  *                - get_file_size()
  *                - copy_bmp_header()
  *                - encode_magic_string()
+ *                - encode_header_flags()
+ *                - encode_shard_header()
+ *                - encode_fec_header()
+ *                - encode_matrix_header()
  *                - encode_secret_file_extn()
  *                - encode_secret_file_extn_size()
  *                - encode_secret_file_size()
  *                - encode_secret_file_data()
  *                - encode_data_to_image()
- *                - encode_byte_to_lsb()
+ *                - encode_matrix_data_to_image()
  *                - encode_int_to_lsb()
+ *                - encode_long_to_lsb()
  *                - copy_remaining_img_data()
+ *                - read_image_block()
+ *                - write_stego_data()
+ *                - verify_matrix_block()
+ *                - verify_stego_digest()
  *
  *  Author      : Pankaj Kumar
  *  Roll No     : 25008_018
@@ -34,7 +48,13 @@
 #ifndef ENCODE_H
 #define ENCODE_H
 
+#include <stdio.h>
 #include "types.h" // Contains user defined types
+#include "common.h" // Contains the name buffer sizes
+#include "bmp.h"   // Contains the pixel formats
+#include "matrix.h" // Contains the matrix embedding state
+#include "pool.h"   // Contains the per job buffers
+#include "progress.h" // Contains the progress and cancellation state
 
 /* 
  * Structure to store information required for
@@ -43,28 +63,84 @@
  * also stored
  */
 
-#define MAX_SECRET_BUF_SIZE 1
-#define MAX_IMAGE_BUF_SIZE (MAX_SECRET_BUF_SIZE * 8)
 #define MAX_FILE_SUFFIX 4
+/* Secret data and image copies are streamed through buffers of this size */
+#define MAX_CHUNK_SIZE (64 * 1024)
+/* Most carrier (payload) bytes in one block buffer */
+#define MAX_BLOCK_CARRIERS (MAX_CHUNK_SIZE / MIN_GROUP_SIZE)
+
+/* --verify levels */
+#define VERIFY_BLOCKS 1         // Read every payload span back from its block buffer
+#define VERIFY_DIGEST 2         // Also match the written file against a digest of the buffers
 
 typedef struct _EncodeInfo
 {
     /* Source Image info */
-    char *src_image_fname;      // => Store the Src Image file name 
+    char src_image_fname[MAX_FNAME]; // => Store the Src Image file name
     FILE *fptr_src_image;       // => Store the Src Image file pointer
-    uint image_capacity;         // => Store the image capacity in bytes
+    uint64_t image_capacity;     // => Store the image capacity in bytes
+    const BmpFormat *format;     // => Store the pixel format of the Src Image
+    uint pixel_offset;           // => Store where the pixel data starts
 
     /* Secret File Info */
-    char *secret_fname;        // => Store the Secret file name
+    char secret_fname[MAX_FNAME]; // => Store the Secret file name
     FILE *fptr_secret;          // => Store the Secret file pointer
-    char extn_secret_file[MAX_FILE_SUFFIX]; // => Store the Secret file extension
-    int secret_size;            // => Store the Secret file size
+    char extn_secret_file[MAX_FILE_SUFFIX + 1]; // => Store the Secret file extension
+    uint64_t secret_size;       // => Store the Secret file size
     int extn_size;              // => Store the Secret file extn Size
 
     /* Stego Image Info */
-    char *stego_image_fname;    // => Store the Stego Image file name
+    char stego_image_fname[MAX_FNAME]; // => Store the Stego Image file name
+    char stego_temp_fname[TEMP_FNAME_SIZE]; // => Store the name written until the job succeeds ("" => none)
     FILE *fptr_stego_image;     // => Store the Stego Image file pointer
 
+    /* Key Info */
+    char magic_string[MAX_MAGIC_LEN + 1]; // => Store the Magic String ("" => prompt user)
+    uint flags;                  // => Store the STEGO_FLAG_* header flags
+
+    /* Shard Info (shard_count == 0 => whole secret in one image) */
+    uint64_t secret_offset;      // => Store where this shard starts in the secret
+    uint payload_id;             // => Store the id shared by all shards
+    uint shard_index;            // => Store this shard's position
+    uint shard_count;            // => Store the number of shards
+
+    /* FEC Info */
+    uint fec_parity;             // => Store RS parity bytes per codeword (0 => no FEC)
+
+    /* Matrix Embedding Info */
+    uint matrix_k;               // => Store message bits per Hamming unit (0 => plain LSB)
+    MatrixCode matrix;           // => Store the secret data's embedding state
+
+    /* Verify Info */
+    uint verify;                 // => Store the VERIFY_* level (0 => no checks)
+    uint64_t verified;           // => Store payload bytes read back from the block buffers
+    uint64_t digest;             // => Store FNV-1a of every byte written to the stego image
+    MatrixCode verify_matrix;    // => Store the read back state of matrix embedded data
+    uint verify_lag;             // => Store 1 while verify_held waits for its last bits
+    unsigned char verify_held;   // => Store the payload byte split across two blocks
+
+    /* Distortion Info */
+    BmpChanges changes;          // => Store the carriers changed so far, counted by the kernels
+
+    /* Cache Info */
+    char *cache_dir;             // => Store the result cache directory (NULL => no cache)
+    uint64_t cache_limit;        // => Store the most bytes the cache may hold
+
+    /* Fan-out Info (payload == NULL => secret data is read from fptr_secret) */
+    const unsigned char *payload; // => Store the secret, FEC coded if enabled, shared read only by all covers
+    uint64_t payload_size;       // => Store the bytes in payload
+
+    /* Mapped Output Info (stego_map == NULL => blocks go through stdio) */
+    uint map_threads;            // => Store the threads copying the tail (0 => no mapping)
+    const unsigned char *src_map; // => Store the cover, mapped read only
+    unsigned char *stego_map;    // => Store the output, mapped shared
+    uint64_t map_size;           // => Store the size of both images
+    uint64_t map_pos;            // => Store the next byte of both to go through
+
+    /* Job Info */
+    JobContext context;          // => Store the pool buffers behind the job's files
+    JobProgress progress;        // => Store the output bytes written, and the progress hooks
+
 } EncodeInfo;
 
 
@@ -76,27 +152,54 @@ OperationType check_operation_type(char *argv[]);
 /* Read and validate Encode args from argv */
 Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo);
 
+/* Copy a name into a MAX_FNAME buffer of the job, fails if it does not fit */
+Status copy_file_name(char *fname, const char *name);
+
 /* Perform the encoding */
 Status do_encoding(EncodeInfo *encInfo);
 
+/* Run the encoding steps on already opened files */
+Status encode_stego_image(EncodeInfo *encInfo);
+
+/* Ask the user for the Magic String */
+Status prompt_magic_string(EncodeInfo *encInfo);
+
+/* Close any open i/p and o/p files */
+void close_files(EncodeInfo *encInfo);
+
 /* Get File pointers for i/p and o/p files */
 Status open_files(EncodeInfo *encInfo);
 
 /* check capacity */
 Status check_capacity(EncodeInfo *encInfo);
 
+/* Get number of payload bytes taken by the header fields */
+uint64_t get_header_size(EncodeInfo *encInfo);
+
 /* Get image size */
-uint get_image_size_for_bmp(FILE *fptr_image);
+uint64_t get_image_size_for_bmp(FILE *fptr_image);
 
 /* Get file size */
-uint get_file_size(FILE *fptr);
+uint64_t get_file_size(FILE *fptr);
 
-/* Copy bmp image header */
-Status copy_bmp_header(FILE *fptr_src_image, FILE *fptr_dest_image);
+/* Copy bmp image header, up to the pixel data */
+Status copy_bmp_header(EncodeInfo *encInfo);
 
 /* Store Magic String */
 Status encode_magic_string(char *magic_string, EncodeInfo *encInfo);
 
+/* Encode header flags */
+Status encode_header_flags(uint flags, EncodeInfo *encInfo);
+
+/* Encode shard index, count and payload id */
+Status encode_shard_header(EncodeInfo *encInfo);
+
+/* Encode FEC parity bytes per codeword */
+Status encode_fec_header(EncodeInfo *encInfo);
+
+/* Encode message bits per Hamming unit */
+Status encode_matrix_header(EncodeInfo *encInfo);
+
 /* Encode secret file extenstion */
 Status encode_secret_file_extn(char *file_extn, EncodeInfo *encInfo);
 
@@ -104,20 +207,36 @@ Status encode_secret_file_extn(char *file_extn, EncodeInfo *encInfo);
 Status encode_secret_file_extn_size(uint file_extn_size, EncodeInfo *encInfo);
 
 /* Encode secret file size */
-Status encode_secret_file_size(long file_size, EncodeInfo *encInfo);
+Status encode_secret_file_size(uint64_t file_size, EncodeInfo *encInfo);
 
 /* Encode secret file data*/
 Status encode_secret_file_data(EncodeInfo *encInfo);
 
-/* Encode function, which does the real encoding */
-Status encode_data_to_image(char *data, int size, FILE *fptr_src_image, FILE *fptr_stego_image);
+/* Encode function, which does the real encoding, a block at a time */
+Status encode_data_to_image(const char *data, uint64_t size, EncodeInfo *encInfo);
+
+/* Matrix embed data after the previous call's, size 0 writes the last part filled unit */
+Status encode_matrix_data_to_image(const char *data, uint64_t size, EncodeInfo *encInfo);
 
-/* Encode a byte into LSB of image data array */
-Status encode_byte_to_lsb(char data,  char *image_buffer);
+/* Encode a 32 bit int, MSB first */
+Status encode_int_to_lsb(uint size, EncodeInfo *encInfo);
 
-Status encode_int_to_lsb(uint size, FILE *fptr_src_image, FILE *fptr_stego_image);
+/* Encode a 64 bit size, MSB first */
+Status encode_long_to_lsb(uint64_t size, EncodeInfo *encInfo);
 
 /* Copy remaining image bytes from src to stego image after encoding */
-Status copy_remaining_img_data(FILE *fptr_src, FILE *fptr_dest);
+Status copy_remaining_img_data(EncodeInfo *encInfo);
+
+/* Next len bytes of the cover, read into buffer or found in the output mapping */
+unsigned char *read_image_block(unsigned char *buffer, size_t len, EncodeInfo *encInfo);
+
+/* Write to the stego image, folding the bytes into the digest when verifying */
+Status write_stego_data(const void *data, size_t len, EncodeInfo *encInfo);
+
+/* Check a matrix embedded block reads back as the payload bytes it consumed */
+Status verify_matrix_block(const unsigned char *image, size_t units, const char *data, size_t used, EncodeInfo *encInfo);
+
+/* Read the written stego image back from the page cache and match its digest */
+Status verify_stego_digest(EncodeInfo *encInfo);
 
 #endif
@@ -0,0 +1,540 @@
+/***********************************************************************
+ *  File Name   : fec.c
+ *  Description : Source file for the Forward Error Correction Module.
+ *                Systematic Reed-Solomon code over GF(2^8) (polynomial
+ *                0x11d, first root alpha^0). Data is cut into codewords of
+ *                255 - parity data bytes plus parity bytes, the last one
+ *                shortened. All field arithmetic is table driven: encoding
+ *                and the clean-codeword check run the parity register 16
+ *                data bytes per step, like a slicing-by-16 CRC: the bytes
+ *                each pick a precomputed row, independent of each other,
+ *                that is XORed in 128 bits at a time, and the register
+ *                moves down a whole vector (little endian layout). Four
+ *                codewords run side by side, as every step of one waits
+ *                on the step before. Only codewords that actually hold errors
+ *                go on to the syndromes, which are read off the remainder
+ *                rather than the codeword, and Berlekamp-Massey / Chien /
+ *                Forney.
+ *
+ *                Functions:
+ *                - init_fec()
+ *                - get_fec_codec()
+ *                - get_fec_encoded_size()
+ *                - get_fec_data_capacity()
+ *                - encode_fec_chunk()
+ *                - decode_fec_chunk()
+ *                - encode_fec_block()
+ *                - decode_fec_block()
+ *                - do_fec_benchmark()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "types.h"
+#include "fec.h"
+
+#define GF_POLY 0x11d
+
+/* alpha^i for i in 0..509 (doubled so sums of two logs need no modulo) and log of 1..255 */
+static unsigned char gf_exp[512];
+static unsigned char gf_log[256];
+static pthread_once_t gf_once = PTHREAD_ONCE_INIT;
+/* One codec per parity, built by the first job to need it and shared by all
+   later ones (about 280 KB each, too big for a worker's stack) */
+static FecCodec *fec_codecs[MAX_FEC_PARITY + 1];
+static pthread_mutex_t fec_codecs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void init_gf_tables(void)
+{
+    uint x = 1;
+    for(int i = 0; i < 255; i++)
+    {
+        gf_exp[i] = x;
+        gf_log[x] = i;
+        x <<= 1;
+        if(x & 0x100)
+            x ^= GF_POLY;
+    }
+    for(int i = 255; i < 512; i++)
+        gf_exp[i] = gf_exp[i - 255];
+}
+
+static unsigned char gf_mul(unsigned char a, unsigned char b)
+{
+    if(a == 0 || b == 0)
+        return 0;
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static unsigned char gf_div(unsigned char a, unsigned char b)
+{
+    if(a == 0)
+        return 0;
+    return gf_exp[gf_log[a] + 255 - gf_log[b]];
+}
+
+/* Evaluate poly[0] + poly[1] x + ... + poly[degree] x^degree at x */
+static unsigned char gf_poly_eval(const unsigned char *poly, int degree, unsigned char x)
+{
+    unsigned char y = 0;
+    for(int i = degree; i >= 0; i--)
+        y = gf_mul(y, x) ^ poly[i];
+    return y;
+}
+
+Status init_fec(FecCodec *codec, uint parity)
+{
+    unsigned char gen[MAX_FEC_PARITY + 1] = { 1 };
+
+    if(parity < MIN_FEC_PARITY || parity > MAX_FEC_PARITY)
+    {
+        fprintf(stderr, "Error: FEC parity should be between %d and %d bytes\n", MIN_FEC_PARITY, MAX_FEC_PARITY);
+        return e_failure;
+    }
+    pthread_once(&gf_once, init_gf_tables);
+
+    // g(x) = (x + alpha^0)(x + alpha^1)...(x + alpha^(parity-1)), gen[k] is the x^k coefficient
+    for(uint i = 0; i < parity; i++)
+    {
+        for(int k = i + 1; k > 0; k--)
+            gen[k] = gen[k - 1] ^ gf_mul(gen[k], gf_exp[i]);
+        gen[0] = gf_mul(gen[0], gf_exp[i]);
+    }
+    // Row v holds v * g_(parity-1-j) in register byte j, zero past the parity bytes
+    codec->parity = parity;
+    codec->words = (parity + 7) / 8;
+    codec->vectors = (parity + 15) / 16;
+    memset(codec->gen_table, 0, sizeof(codec->gen_table));
+    for(uint v = 0; v < 256; v++)
+    {
+        unsigned char *row = (unsigned char *)codec->gen_table[v];
+        for(uint j = 0; j < parity; j++)
+            row[j] = gf_mul(v, gen[parity - 1 - j]);
+    }
+    // Slice t is byte v fed in at position t of a 16 byte step into a clear
+    // register, then run through the remaining steps with zero input
+    for(uint t = 0; t < FEC_SLICES; t++)
+    {
+        for(uint v = 0; v < 256; v++)
+        {
+            uint64_t reg[FEC_REG_WORDS + 1] = {0};
+            for(uint step = t; step < FEC_SLICES; step++)
+            {
+                const uint64_t *row = codec->gen_table[(unsigned char)((step == t ? v : 0) ^ reg[0])];
+                for(uint w = 0; w < codec->words; w++)
+                    reg[w] = ((reg[w] >> 8) | (reg[w + 1] << 56)) ^ row[w];
+            }
+            memcpy(&codec->slice_table[(t * 256 + v) * codec->vectors], reg, codec->vectors * sizeof(FecVector));
+        }
+    }
+    return e_success;
+}
+
+const FecCodec *get_fec_codec(uint parity)
+{
+    if(parity < MIN_FEC_PARITY || parity > MAX_FEC_PARITY)
+    {
+        fprintf(stderr, "Error: FEC parity should be between %d and %d bytes\n", MIN_FEC_PARITY, MAX_FEC_PARITY);
+        return NULL;
+    }
+    // Built once, only ever read afterwards, so no lock once it is there
+    FecCodec *codec = __atomic_load_n(&fec_codecs[parity], __ATOMIC_ACQUIRE);
+    if(codec != NULL)
+        return codec;
+    pthread_mutex_lock(&fec_codecs_lock);
+    codec = fec_codecs[parity];
+    if(codec == NULL)
+    {
+        void *mem = NULL;
+        if(posix_memalign(&mem, sizeof(FecVector), sizeof(FecCodec)) != 0 || init_fec(mem, parity) == e_failure)
+        {
+            fprintf(stderr, "Error: Unable to set up the FEC codec for parity %u\n", parity);
+            free(mem);
+            mem = NULL;
+        }
+        codec = mem;
+        __atomic_store_n(&fec_codecs[parity], codec, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&fec_codecs_lock);
+    return codec;
+}
+
+uint64_t get_fec_encoded_size(uint64_t size, uint parity)
+{
+    uint64_t data_per_block = FEC_BLOCK_SIZE - parity;
+    uint64_t rest = size % data_per_block;
+    // Full codewords plus a shortened last one
+    return size / data_per_block * FEC_BLOCK_SIZE + (rest ? rest + parity : 0);
+}
+
+uint64_t get_fec_data_capacity(uint64_t capacity, uint parity)
+{
+    uint64_t rest = capacity % FEC_BLOCK_SIZE;
+    return capacity / FEC_BLOCK_SIZE * (FEC_BLOCK_SIZE - parity) + (rest > parity ? rest - parity : 0);
+}
+
+/*
+ * Sixteen LFSR steps at once: the low register vector only ever meets the
+ * input, so the input XOR that vector picks one row per byte, and the rest
+ * of the register moves down a vector.
+ */
+static inline __attribute__((always_inline))
+void fec_slice_step(const FecVector *slices, FecVector in, FecVector *r, const uint vectors)
+{
+    in ^= r[0];
+    uint64_t half[2] = { in[0], in[1] };
+    FecVector acc[FEC_REG_VECTORS];
+#pragma GCC unroll 4
+    for(uint w = 0; w < vectors; w++)
+        acc[w] = r[w + 1];
+    // Fully unrolled, or the register goes through memory every step
+#pragma GCC unroll 16
+    for(uint t = 0; t < FEC_SLICES; t++)
+    {
+        const FecVector *row = slices + (t * 256 + (half[t / 8] >> (8 * (t % 8)) & 0xff)) * vectors;
+#pragma GCC unroll 4
+        for(uint w = 0; w < vectors; w++)
+            acc[w] ^= row[w];
+    }
+#pragma GCC unroll 4
+    for(uint w = 0; w < vectors; w++)
+        r[w] = acc[w];
+}
+
+/*
+ * Each codeword is one long chain of dependent steps, so lanes codewords
+ * run side by side to keep the CPU busy. A clear register stays clear on
+ * zero bytes, so the len % 16 bytes in front go in as a step of their own
+ * padded with leading zeros, and every step is a whole one. Inlined once
+ * per lane count and register width, so the registers stay in CPU
+ * registers.
+ */
+static inline __attribute__((always_inline))
+void fec_remainder_slices(const FecVector *slices, const unsigned char *const *bytes, uint len,
+                          FecVector (*reg)[FEC_REG_VECTORS + 1], const uint lanes, const uint vectors)
+{
+    FecVector r[FEC_LANES][FEC_REG_VECTORS + 1] = {{{0}}};
+    uint head = len % FEC_SLICES;
+    if(head)
+    {
+#pragma GCC unroll 4
+        for(uint l = 0; l < lanes; l++)
+        {
+            unsigned char first[FEC_SLICES] = {0};
+            FecVector in;
+            memcpy(first + FEC_SLICES - head, bytes[l], head);
+            memcpy(&in, first, sizeof(in));
+            fec_slice_step(slices, in, r[l], vectors);
+        }
+    }
+    for(uint i = head; i < len; i += FEC_SLICES)
+    {
+#pragma GCC unroll 4
+        for(uint l = 0; l < lanes; l++)
+        {
+            FecVector in;
+            memcpy(&in, bytes[l] + i, sizeof(in));
+            fec_slice_step(slices, in, r[l], vectors);
+        }
+    }
+#pragma GCC unroll 4
+    for(uint l = 0; l < lanes; l++)
+    {
+#pragma GCC unroll 4
+        for(uint w = 0; w < vectors; w++)
+            reg[l][w] = r[l][w];
+    }
+}
+
+/* Both lane counts of one register width */
+#define FEC_SLICES_CASE(w) \
+    case w: \
+        if(lanes == 1) \
+            fec_remainder_slices(slices, bytes, len, reg, 1, w); \
+        else \
+            fec_remainder_slices(slices, bytes, len, reg, FEC_LANES, w); \
+        break
+
+/*
+ * Remainders of (bytes * x^parity) mod g(x) of 1 or FEC_LANES codewords of
+ * len bytes each, the LFSR shared by encoding and checking. Register byte
+ * j is the x^(parity-1-j) coefficient, each step moves every byte down
+ * one place and XORs in the feedback row.
+ */
+static void fec_remainders(const FecCodec *codec, const unsigned char *const *bytes, uint lanes, uint len, unsigned char **out)
+{
+    FecVector reg[FEC_LANES][FEC_REG_VECTORS + 1] = {{{0}}};
+    const FecVector *slices = codec->slice_table;
+    switch(codec->vectors)
+    {
+        FEC_SLICES_CASE(1);
+        FEC_SLICES_CASE(2);
+        FEC_SLICES_CASE(3);
+        default: FEC_SLICES_CASE(FEC_REG_VECTORS);
+    }
+    for(uint l = 0; l < lanes; l++)
+        memcpy(out[l], reg[l], codec->parity);
+}
+
+/* Remainder of a single codeword */
+static void fec_remainder(const FecCodec *codec, const unsigned char *bytes, uint len, unsigned char *out)
+{
+    fec_remainders(codec, &bytes, 1, len, &out);
+}
+
+void encode_fec_block(const FecCodec *codec, const unsigned char *data, uint len, unsigned char *parity)
+{
+    fec_remainder(codec, data, len, parity);
+}
+
+/* Nonzero if the remainder of a codeword is all zero bytes */
+static int fec_is_clean(const unsigned char *reg, uint parity)
+{
+    unsigned char any = 0;
+    for(uint j = 0; j < parity; j++)
+        any |= reg[j];
+    return any == 0;
+}
+
+/* Correct a codeword whose remainder reg is not zero, returns bytes corrected or -1 */
+static int correct_fec_block(const FecCodec *codec, unsigned char *codeword, uint len, const unsigned char *reg)
+{
+    uint parity = codec->parity;
+    unsigned char check[MAX_FEC_PARITY];
+    unsigned char synd[MAX_FEC_PARITY];
+    unsigned char lambda[MAX_FEC_PARITY + 1] = { 1 };
+    unsigned char prev[MAX_FEC_PARITY + 1] = { 1 };
+    unsigned char omega[MAX_FEC_PARITY];
+    uint positions[MAX_FEC_PARITY];
+    int errors = 0;
+
+    // Syndromes S_i = c(alpha^i). g(alpha^i) = 0, so the remainder r(x) of
+    // c(x) x^parity has r(alpha^i) = S_i alpha^(i parity): parity bytes to
+    // evaluate instead of the whole codeword
+    for(uint i = 0; i < parity; i++)
+    {
+        unsigned char s = 0;
+        for(uint j = 0; j < parity; j++)
+            s = gf_mul(s, gf_exp[i]) ^ reg[j];
+        synd[i] = gf_mul(s, gf_exp[(255 - (i * parity) % 255) % 255]);
+    }
+
+    // Berlekamp-Massey, error locator lambda(x) of degree order
+    int order = 0, shift = 1;
+    unsigned char last = 1;
+    for(uint r = 0; r < parity; r++)
+    {
+        unsigned char delta = synd[r];
+        for(int i = 1; i <= order; i++)
+            delta ^= gf_mul(lambda[i], synd[r - i]);
+        if(delta == 0)
+        {
+            shift++;
+            continue;
+        }
+        unsigned char temp[MAX_FEC_PARITY + 1];
+        memcpy(temp, lambda, sizeof(temp));
+        unsigned char scale = gf_div(delta, last);
+        for(uint i = 0; i + shift <= parity; i++)
+            lambda[i + shift] ^= gf_mul(scale, prev[i]);
+        if(2 * order <= (int)r)
+        {
+            order = r + 1 - order;
+            memcpy(prev, temp, sizeof(prev));
+            last = delta;
+            shift = 1;
+        }
+        else
+            shift++;
+    }
+    if(order == 0 || 2 * order > (int)parity)
+        return -1;
+
+    // Chien search, byte j sits at power len - 1 - j
+    for(uint j = 0; j < len; j++)
+    {
+        uint power = len - 1 - j;
+        unsigned char x_inv = gf_exp[(255 - power) % 255];
+        if(gf_poly_eval(lambda, order, x_inv) == 0)
+        {
+            if(errors == order)
+                return -1;
+            positions[errors++] = j;
+        }
+    }
+    if(errors != order)
+        return -1;
+
+    // omega(x) = S(x) lambda(x) mod x^parity
+    for(uint i = 0; i < parity; i++)
+    {
+        omega[i] = 0;
+        for(uint k = 0; k <= i && k <= (uint)order; k++)
+            omega[i] ^= gf_mul(lambda[k], synd[i - k]);
+    }
+    // Forney: e = X omega(X^-1) / lambda'(X^-1)
+    for(int e = 0; e < errors; e++)
+    {
+        uint power = len - 1 - positions[e];
+        unsigned char x = gf_exp[power];
+        unsigned char x_inv = gf_exp[(255 - power) % 255];
+        unsigned char derivative = 0;
+        for(int i = 1; i <= order; i += 2)
+            derivative ^= gf_mul(lambda[i], gf_exp[(gf_log[x_inv] * (i - 1)) % 255]);
+        if(derivative == 0)
+            return -1;
+        unsigned char value = gf_poly_eval(omega, parity - 1, x_inv);
+        codeword[positions[e]] ^= gf_mul(x, gf_div(value, derivative));
+    }
+
+    // Too many errors can still look locatable, only accept a real codeword
+    fec_remainder(codec, codeword, len, check);
+    if(!fec_is_clean(check, parity))
+        return -1;
+    return errors;
+}
+
+int decode_fec_block(const FecCodec *codec, unsigned char *codeword, uint len)
+{
+    unsigned char reg[MAX_FEC_PARITY];
+    // Clean codeword => divisible by g(x), the common case costs no more than encoding
+    fec_remainder(codec, codeword, len, reg);
+    if(fec_is_clean(reg, codec->parity))
+        return 0;
+    return correct_fec_block(codec, codeword, len, reg);
+}
+
+size_t encode_fec_chunk(const FecCodec *codec, const unsigned char *data, size_t len, unsigned char *coded)
+{
+    uint data_per_block = FEC_BLOCK_SIZE - codec->parity;
+    size_t out = 0;
+    size_t i = 0;
+    // Full codewords FEC_LANES at a time
+    for(; len - i >= (size_t)FEC_LANES * data_per_block; i += FEC_LANES * data_per_block)
+    {
+        const unsigned char *blocks[FEC_LANES];
+        unsigned char *parities[FEC_LANES];
+        for(uint l = 0; l < FEC_LANES; l++)
+        {
+            blocks[l] = data + i + (size_t)l * data_per_block;
+            parities[l] = coded + out + (size_t)l * FEC_BLOCK_SIZE + data_per_block;
+            memcpy(coded + out + (size_t)l * FEC_BLOCK_SIZE, blocks[l], data_per_block);
+        }
+        fec_remainders(codec, blocks, FEC_LANES, data_per_block, parities);
+        out += FEC_LANES * FEC_BLOCK_SIZE;
+    }
+    for(; i < len; i += data_per_block)
+    {
+        uint block = (len - i) < data_per_block ? (uint)(len - i) : data_per_block;
+        // Systematic code: data bytes as is, parity bytes behind them
+        memcpy(coded + out, data + i, block);
+        encode_fec_block(codec, data + i, block, coded + out + block);
+        out += block + codec->parity;
+    }
+    return out;
+}
+
+long decode_fec_chunk(const FecCodec *codec, unsigned char *coded, size_t len, unsigned char *data)
+{
+    uint data_per_block = FEC_BLOCK_SIZE - codec->parity;
+    long corrected = 0;
+    size_t i = 0;
+    // Full codewords FEC_LANES at a time, only the ones with errors go on to correction
+    for(; len - i >= (size_t)FEC_LANES * data_per_block; i += FEC_LANES * data_per_block)
+    {
+        const unsigned char *blocks[FEC_LANES];
+        unsigned char regs[FEC_LANES][MAX_FEC_PARITY];
+        unsigned char *outs[FEC_LANES];
+        for(uint l = 0; l < FEC_LANES; l++)
+        {
+            blocks[l] = coded + (size_t)l * FEC_BLOCK_SIZE;
+            outs[l] = regs[l];
+        }
+        fec_remainders(codec, blocks, FEC_LANES, FEC_BLOCK_SIZE, outs);
+        for(uint l = 0; l < FEC_LANES; l++)
+        {
+            if(!fec_is_clean(regs[l], codec->parity))
+            {
+                int fixed = correct_fec_block(codec, coded, FEC_BLOCK_SIZE, regs[l]);
+                if(fixed < 0)
+                    return -1;
+                corrected += fixed;
+            }
+            memcpy(data + i + (size_t)l * data_per_block, coded, data_per_block);
+            coded += FEC_BLOCK_SIZE;
+        }
+    }
+    for(; i < len; i += data_per_block)
+    {
+        uint block = (len - i) < data_per_block ? (uint)(len - i) : data_per_block;
+        int fixed = decode_fec_block(codec, coded, block + codec->parity);
+        if(fixed < 0)
+            return -1;
+        corrected += fixed;
+        memcpy(data + i, coded, block);
+        coded += block + codec->parity;
+    }
+    return corrected;
+}
+
+static double elapsed_seconds(struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+Status do_fec_benchmark(uint megabytes, uint parity)
+{
+    size_t len = (size_t)megabytes * 1024 * 1024;
+    const FecCodec *codec = get_fec_codec(parity);
+    if(codec == NULL)
+        return e_failure;
+    unsigned char *data = malloc(len);
+    unsigned char *check = malloc(len);
+    unsigned char *coded = malloc(get_fec_encoded_size(len, parity));
+    if(data == NULL || check == NULL || coded == NULL)
+    {
+        fprintf(stderr, "Error: Unable to allocate %u MB benchmark buffers\n", megabytes);
+        free(data);
+        free(check);
+        free(coded);
+        return e_failure;
+    }
+    for(size_t i = 0; i < len; i++)
+        data[i] = (unsigned char)(i * 2654435761u >> 13);
+    // Output pages faulted in up front, so the rates are the codec's alone
+    memset(check, 0, len);
+    memset(coded, 0, get_fec_encoded_size(len, parity));
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    encode_fec_chunk(codec, data, len, coded);
+    double encode_time = elapsed_seconds(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long corrected = decode_fec_chunk(codec, coded, len, check);
+    double decode_time = elapsed_seconds(&start);
+
+    Status ret = e_success;
+    if(corrected != 0 || memcmp(data, check, len) != 0)
+    {
+        fprintf(stderr, "Error: FEC does not round trip\n");
+        ret = e_failure;
+    }
+    // Rates are data bytes per second
+    printf("%-8s %8u MB %12.1f %12.1f\n", "rs-fec", megabytes, megabytes / encode_time, megabytes / decode_time);
+    free(data);
+    free(check);
+    free(coded);
+    return ret;
+}
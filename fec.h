@@ -0,0 +1,90 @@
+/***********************************************************************
+ *  File Name   : fec.h
+ *  Description : Header file for the Forward Error Correction Module.
+ *                Contains the Reed-Solomon codec definition and function
+ *                declarations used for protecting the secret data against
+ *                flipped bits in the stego image.
+ *
+ *                Structures:
+ *                - FecCodec
+ *
+ *                Functions:
+ *                - init_fec()
+ *                - get_fec_codec()
+ *                - get_fec_encoded_size()
+ *                - get_fec_data_capacity()
+ *                - encode_fec_chunk()
+ *                - decode_fec_chunk()
+ *                - encode_fec_block()
+ *                - decode_fec_block()
+ *                - do_fec_benchmark()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef FEC_H
+#define FEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "types.h"
+
+/* Reed-Solomon over GF(2^8): codewords of up to 255 bytes */
+#define FEC_BLOCK_SIZE 255
+/* Parity bytes per codeword, corrects up to parity / 2 bad bytes */
+#define MIN_FEC_PARITY 2
+#define MAX_FEC_PARITY 64
+/* Codewords handled per streamed chunk */
+#define FEC_BLOCKS_PER_CHUNK 256
+/* Parity register as 64 bit words, and as 128 bit vectors */
+#define FEC_REG_WORDS (MAX_FEC_PARITY / 8)
+#define FEC_REG_VECTORS (MAX_FEC_PARITY / 16)
+/* Data bytes the parity register takes per step, one vector */
+#define FEC_SLICES 16
+/* Full codewords whose registers run side by side */
+#define FEC_LANES 4
+
+/* Two 64 bit words handled as one (SSE2 / NEON register, plain words elsewhere) */
+typedef uint64_t FecVector __attribute__((vector_size(16)));
+
+typedef struct _FecCodec
+{
+    uint parity;                                  // => Store parity bytes per codeword
+    uint words;                                   // => Store 64 bit words in use by the register
+    uint vectors;                                 // => Store 128 bit vectors in use by the register
+    uint64_t gen_table[256][FEC_REG_WORDS];       // => Store v * g(x) row for every feedback byte v
+    /* Row for byte v at position t of a 16 byte step, vectors apart: [(t * 256 + v) * vectors] */
+    FecVector slice_table[FEC_SLICES * 256 * FEC_REG_VECTORS];
+
+} FecCodec;
+
+/* Set up a codec with the given parity bytes per codeword */
+Status init_fec(FecCodec *codec, uint parity);
+
+/* Shared codec for parity, built on first use, NULL on failure */
+const FecCodec *get_fec_codec(uint parity);
+
+/* Get the coded size of size data bytes */
+uint64_t get_fec_encoded_size(uint64_t size, uint parity);
+
+/* Get the most data bytes whose coded size fits in capacity */
+uint64_t get_fec_data_capacity(uint64_t capacity, uint parity);
+
+/* Encode len data bytes into consecutive codewords, returns the coded length */
+size_t encode_fec_chunk(const FecCodec *codec, const unsigned char *data, size_t len, unsigned char *coded);
+
+/* Decode codewords back into len data bytes, returns bytes corrected or -1 */
+long decode_fec_chunk(const FecCodec *codec, unsigned char *coded, size_t len, unsigned char *data);
+
+/* Compute the parity of one codeword of len data bytes */
+void encode_fec_block(const FecCodec *codec, const unsigned char *data, uint len, unsigned char *parity);
+
+/* Correct one codeword of len bytes in place, returns bytes corrected or -1 */
+int decode_fec_block(const FecCodec *codec, unsigned char *codeword, uint len);
+
+/* Time encoding and clean-block decoding */
+Status do_fec_benchmark(uint megabytes, uint parity);
+
+#endif
@@ -0,0 +1,227 @@
+/***********************************************************************
+ *  File Name   : handoff.c
+ *  Description : Source file for the Secret Handoff Module.
+ *                A memfd decode writes the secret into an anonymous
+ *                memory file named after it (with the decoded extension)
+ *                instead of a file on disk. The memfd is sized to the
+ *                secret up front and, once the last block is in, sealed
+ *                against writes, growing and shrinking, so whoever gets
+ *                the descriptor can trust it stays exactly as decoded and
+ *                may mmap() it. The descriptor is then handed on without
+ *                copying the data again:
+ *                  --exec=command : command runs through /bin/sh with the
+ *                                   secret as its stdin, and its name and
+ *                                   size in STEGO_SECRET_NAME and
+ *                                   STEGO_SECRET_SIZE.
+ *                  --send=socket  : the descriptor goes over the Unix
+ *                                   socket (SCM_RIGHTS) with the line
+ *                                   "<name> <size>\n".
+ *                Daemon requests with --memfd get it with their reply.
+ *
+ *                Functions:
+ *                - open_secret_memfd()
+ *                - seal_secret_memfd()
+ *                - hand_off_secret()
+ *                - run_secret_consumer()
+ *                - send_secret_to_socket()
+ *                - send_secret_fd()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+/* memfd_create() and the F_*_SEALS commands */
+#define _GNU_SOURCE
+/* 64-bit off_t for ftruncate() on large secrets */
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "types.h"
+#include "decode.h"
+#include "handoff.h"
+
+Status open_secret_memfd(DecodeInfo *decInfo)
+{
+    int fd = memfd_create(decInfo->secret_fname, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if(fd < 0)
+    {
+        perror("memfd_create");
+        fprintf(stderr, "ERROR: Unable to create a memfd for \"%s\"\n", decInfo->secret_fname);
+        return e_failure;
+    }
+    // Sized once here, the blocks then fill it in place instead of growing it
+    if(ftruncate(fd, decInfo->secret_size) != 0)
+    {
+        perror("ftruncate");
+        close(fd);
+        return e_failure;
+    }
+    // The job writes through its own copy of the descriptor, which
+    // close_decode_files() closes; secret_fd stays open for the handoff
+    int write_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    decInfo->fptr_secret = (write_fd < 0) ? NULL : fdopen(write_fd, "wb");
+    if(decInfo->fptr_secret == NULL)
+    {
+        perror("fdopen");
+        if(write_fd >= 0)
+            close(write_fd);
+        close(fd);
+        return e_failure;
+    }
+    decInfo->secret_fd = fd;
+    set_job_buffer(decInfo->fptr_secret, &decInfo->context, JOB_BUFFER_SECRET);
+    printf("Secret memfd with name \"%s\" created Successfully\n", decInfo->secret_fname);
+    return e_success;
+}
+
+Status seal_secret_memfd(DecodeInfo *decInfo, Status ret)
+{
+    if(decInfo->secret_fd < 0)
+        return ret;
+    // No writable mapping of it exists, so the write seal cannot be refused
+    if(ret == e_success && fcntl(decInfo->secret_fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0)
+    {
+        perror("fcntl");
+        fprintf(stderr, "ERROR: Unable to seal the memfd of \"%s\"\n", decInfo->secret_fname);
+        ret = e_failure;
+    }
+    if(ret == e_failure)
+    {
+        close(decInfo->secret_fd);
+        decInfo->secret_fd = -1;
+        return ret;
+    }
+    printf("Secret memfd of %" PRIu64 " bytes sealed Successfully\n", decInfo->secret_size);
+    return ret;
+}
+
+Status hand_off_secret(DecodeInfo *decInfo)
+{
+    Status ret = e_success;
+    if(decInfo->handoff_command)
+        ret = run_secret_consumer(decInfo, decInfo->handoff_command);
+    if(ret == e_success && decInfo->handoff_socket)
+        ret = send_secret_to_socket(decInfo, decInfo->handoff_socket);
+    // The consumers hold their own references, ours is no longer needed
+    close(decInfo->secret_fd);
+    decInfo->secret_fd = -1;
+    return ret;
+}
+
+Status run_secret_consumer(DecodeInfo *decInfo, const char *command)
+{
+    char size[24];
+    snprintf(size, sizeof(size), "%" PRIu64, decInfo->secret_size);
+    // The job's writes left the shared offset at the end
+    lseek(decInfo->secret_fd, 0, SEEK_SET);
+    // Nothing buffered may be printed twice by the child
+    fflush(stdout);
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        perror("fork");
+        return e_failure;
+    }
+    if(pid == 0)
+    {
+        // dup2() drops close-on-exec, so only the stdin copy reaches the command
+        if(dup2(decInfo->secret_fd, STDIN_FILENO) < 0)
+            _exit(127);
+        setenv("STEGO_SECRET_NAME", decInfo->secret_fname, 1);
+        setenv("STEGO_SECRET_SIZE", size, 1);
+        execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+        _exit(127);
+    }
+
+    int status;
+    // Ctrl-C interrupts the wait, the command got the signal as well
+    while(waitpid(pid, &status, 0) < 0)
+    {
+        if(errno != EINTR)
+        {
+            perror("waitpid");
+            return e_failure;
+        }
+    }
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "Error: \"%s\" failed with status %d\n", command, WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
+        return e_failure;
+    }
+    printf("Secret handed to \"%s\" Successfully\n", command);
+    return e_success;
+}
+
+Status send_secret_to_socket(DecodeInfo *decInfo, const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "Error: Socket path \"%s\" is too long\n", path);
+        return e_failure;
+    }
+    strcpy(addr.sun_path, path);
+
+    int sock_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(sock_fd < 0 || connect(sock_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        perror("connect");
+        fprintf(stderr, "ERROR: Unable to connect to \"%s\"\n", path);
+        if(sock_fd >= 0)
+            close(sock_fd);
+        return e_failure;
+    }
+    char line[HANDOFF_LINE_SIZE];
+    snprintf(line, sizeof(line), "%s %" PRIu64 "\n", decInfo->secret_fname, decInfo->secret_size);
+    Status ret = send_secret_fd(sock_fd, line, decInfo->secret_fd);
+    close(sock_fd);
+    if(ret == e_success)
+        printf("Secret sent to \"%s\" Successfully\n", path);
+    return ret;
+}
+
+Status send_secret_fd(int sock_fd, const char *line, int fd)
+{
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { (void *)line, strlen(line) };
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    // The descriptor travels with the first byte of the line
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    // The offset is shared with the receiver, and the job's writes (or an
+    // --exec command's reads) left it at the end, so read() would see nothing
+    if(lseek(fd, 0, SEEK_SET) != 0)
+    {
+        perror("lseek");
+        return e_failure;
+    }
+    // A peer that already left is an error here, not a SIGPIPE
+    if(sendmsg(sock_fd, &msg, MSG_NOSIGNAL) != (ssize_t)iov.iov_len)
+    {
+        perror("sendmsg");
+        return e_failure;
+    }
+    return e_success;
+}
@@ -0,0 +1,49 @@
+/***********************************************************************
+ *  File Name   : handoff.h
+ *  Description : Header file for the Secret Handoff Module.
+ *                Contains the definitions and function declarations used
+ *                for decoding into a sealed memfd instead of a file, and
+ *                handing that descriptor to its consumer: a child process
+ *                (as its stdin) or a peer on a Unix domain socket.
+ *
+ *                Functions:
+ *                - open_secret_memfd()
+ *                - seal_secret_memfd()
+ *                - hand_off_secret()
+ *                - run_secret_consumer()
+ *                - send_secret_to_socket()
+ *                - send_secret_fd()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include "types.h"
+#include "decode.h"
+
+/* Longest "<name> <size>" line sent along with the descriptor */
+#define HANDOFF_LINE_SIZE (MAX_FNAME + 32)
+
+/* Create the memfd, named after the secret, and point fptr_secret at it */
+Status open_secret_memfd(DecodeInfo *decInfo);
+
+/* Seal the finished memfd read only, close it when the job failed */
+Status seal_secret_memfd(DecodeInfo *decInfo, Status ret);
+
+/* Give the sealed memfd to the --exec command or the --send socket, then close it */
+Status hand_off_secret(DecodeInfo *decInfo);
+
+/* Run command through /bin/sh with the secret as its stdin, wait for it */
+Status run_secret_consumer(DecodeInfo *decInfo, const char *command);
+
+/* Connect to the Unix socket at path and send the secret's descriptor */
+Status send_secret_to_socket(DecodeInfo *decInfo, const char *path);
+
+/* Rewind fd and send line with it attached (SCM_RIGHTS) on a connected socket */
+Status send_secret_fd(int sock_fd, const char *line, int fd);
+
+#endif
@@ -7,6 +7,49 @@
  *                Supported Operations:
  *                - Encoding: Embeds a secret file into a BMP image.
  *                - Decoding: Extracts a hidden file from a stego BMP.
+ *                - Daemon  : Serves encode/decode jobs over a Unix socket.
+ *                - Sharding: Splits one secret across several BMPs and
+ *                            rebuilds it from them.
+ *                - Fan-out : Copies one secret into several BMPs, each
+ *                            under its own key.
+ *                - Benchmark: Times the embed/extract kernel of every
+ *                             supported pixel format.
+ *
+ *                Options (anywhere after the operation, each one only
+ *                with the operations listed for it):
+ *                - --fec[=parity] : Reed-Solomon protect the secret data
+ *                                   (encode / shard encode / fan-out /
+ *                                   benchmark).
+ *                - --matrix[=k]   : Hamming matrix embed the secret data,
+ *                                   fewer changed cover bytes (encode /
+ *                                   shard encode / fan-out / benchmark).
+ *                - --verify[=digest] : Read the payload back from every
+ *                                   block before writing it, =digest also
+ *                                   checks the written file (encode /
+ *                                   shard encode / fan-out).
+ *                - --cache=dir [--cache-size=MB] : Serve repeated encodes
+ *                                   from a result cache (encode).
+ *                - --keys=file    : Try every magic string in file, one
+ *                                   extraction of the image for all (decode),
+ *                                   or one key per cover in order (fan-out).
+ *                - --plane        : Keep the extracted LSB plane in
+ *                                   "<stego.bmp>.lsb" for later runs (decode).
+ *                - --mmap[=threads] : Encode through mappings of the cover
+ *                                   and output, the rest of the image copied
+ *                                   by several threads (encode / shard
+ *                                   encode / fan-out).
+ *                - --exec=command / --send=socket : Decode into a sealed
+ *                                   memfd and hand it to command as its
+ *                                   stdin, or over a Unix socket (decode).
+ *                - --fd=N         : Decode into the inherited descriptor N
+ *                                   instead of a file (decode).
+ *                - --progress[=fd] : Progress lines (bytes done, rate, ETA)
+ *                                   on stderr or fd while jobs run; a
+ *                                   daemon request sends them to the client.
+ *                - --pool-size=MB [--huge-pages] : Memory for the stdio
+ *                                   buffers of all the jobs running at once,
+ *                                   optionally on huge pages (any operation
+ *                                   that runs jobs).
  *
  *                Usage:
  *                - Encoding:
@@ -15,6 +58,19 @@
  *                - Decoding:
  *                  ./a.out -d <stego.bmp> <output_file>
  *
+ *                - Daemon:
+ *                  ./a.out -s <socket_path> [threads]
+ *
+ *                - Sharding:
+ *                  ./a.out -S <secret.ext> <out_prefix> <cover1.bmp> ...
+ *                  ./a.out -R <output_file> <shard1.bmp> ...
+ *
+ *                - Fan-out:
+ *                  ./a.out -F <secret.ext> <out_prefix> <cover1.bmp> ...
+ *
+ *                - Benchmark:
+ *                  ./a.out -b [megabytes]
+ *
  *  Author      : Pankaj Kumar
  *  Roll No     : 25008_018
  *  Date        : 30-Jul-2025
@@ -22,43 +78,92 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 #include "encode.h"
 #include "types.h"
 #include "decode.h"
+#include "daemon.h"
+#include "shard.h"
+#include "bmp.h"
+#include "fec.h"
+#include "matrix.h"
+#include "options.h"
+#include "cache.h"
+#include "plane.h"
+#include "pool.h"
+#include "progress.h"
+#include "handoff.h"
 
 int main(int argc, char *argv[])
 {
-    if(argc < 3)
+    if(argc < 3 && !(argc == 2 && strcmp(argv[1], "-b") == 0))
     {
         fprintf(stderr, "Correct Syntax: \n");
-        fprintf(stderr, "For Encoding : %s -e <source_file.bmp> <secret_file(\".txt\", \".jpg\", \".sh\", \".c\")> <output_file.bmp>\n", argv[0]);
-        fprintf(stderr, "For Decoding : %s -d <source_file.bmp> <output_file(\".txt\", \".jpg\", \".sh\", \".c\")> \n", argv[0]);   
+        fprintf(stderr, "For Encoding : %s -e <source_file.bmp> <secret_file(\".txt\", \".jpg\", \".sh\", \".c\")> <output_file.bmp> [--fec[=parity]] [--matrix[=k]] [--verify[=digest]] [--cache=dir [--cache-size=MB]] [--mmap[=threads]] [--progress[=fd]]\n", argv[0]);
+        fprintf(stderr, "For Decoding : %s -d <source_file.bmp> <output_file(\".txt\", \".jpg\", \".sh\", \".c\")> [--keys=file] [--plane] [--progress[=fd]] [--exec=command] [--send=socket] [--fd=N]\n", argv[0]);   
+        fprintf(stderr, "For Daemon   : %s -s <socket_path> [threads] [--pool-size=MB] [--huge-pages]\n", argv[0]);
+        fprintf(stderr, "For Sharding : %s -S <secret_file> <output_prefix> <cover1.bmp> [cover2.bmp ...]\n", argv[0]);
+        fprintf(stderr, "For Rebuild  : %s -R <output_file> <shard1.bmp> [shard2.bmp ...]\n", argv[0]);
+        fprintf(stderr, "For Fan-out  : %s -F <secret_file> <output_prefix> <cover1.bmp> [cover2.bmp ...] [--keys=file]\n", argv[0]);
+        fprintf(stderr, "For Benchmark: %s -b [megabytes]\n", argv[0]);
         return -1;
     } 
-    Status operation = check_operation_type(argv);
+    OperationType operation = check_operation_type(argv);
     // check opreation type
     if(operation == e_unsupported)
     {
         return -1;
     }
+    // Pull the --options out, leaving only positional args in argv, and
+    // refuse the ones this operation would otherwise silently ignore
+    Options options = {0};
+    if(read_options(&argc, argv, &options) == e_failure || check_options(&options, get_operation_options(operation), argv[1]) == e_failure)
+        return -1;
+    // Only sizes the pool, it is mapped when the first job starts
+    set_buffer_pool_limits(options.pool_mb, options.huge_pages);
+    // Progress lines of every job of this run
+    FILE *progress_stream = NULL;
+    if(options.progress)
+    {
+        progress_stream = (options.progress_fd == STDERR_FILENO) ? stderr : fdopen(options.progress_fd, "w");
+        if(progress_stream == NULL)
+        {
+            perror("fdopen");
+            fprintf(stderr, "Error: Unable to write progress to descriptor %d\n", options.progress_fd);
+            return -1;
+        }
+    }
+    // Jobs stop at their next block on Ctrl-C, the daemon keeps the default
+    if(operation != e_daemon && operation != e_benchmark)
+        install_cancel_handlers();
     // IF => e_encode
     if(operation == e_encode)
     {
-        EncodeInfo encodeInfo;
+        EncodeInfo encodeInfo = {0};
         if(argc >= 4 && argc <= 5)
         {
             // Validate the input CLA
             if(read_and_validate_encode_args(argv, &encodeInfo) == e_failure)
                 return e_failure;
+            encodeInfo.fec_parity = options.fec_parity;
+            encodeInfo.matrix_k = options.matrix_k;
+            encodeInfo.verify = options.verify;
+            encodeInfo.map_threads = options.map_threads;
+            encodeInfo.progress.stream = progress_stream;
+            encodeInfo.cache_dir = options.cache_dir;
+            encodeInfo.cache_limit = (uint64_t)(options.cache_mb ? options.cache_mb : DEFAULT_CACHE_MB) << 20;
 
-            // Start the encoding
-            do_encoding(&encodeInfo);
+            // Start the encoding, a failed or cancelled one exits non-zero
+            if(do_encoding(&encodeInfo) == e_failure)
+                return e_failure;
         }
         else
         {
             fprintf(stderr, "Correct Syntax for decoding: \n");
             fprintf(stderr, "%s -e <source_file.bmp> <secret_file(\".txt\", \".jpg\", \".sh\", \".c\")> <output_file.bmp>\n", argv[0]);
+            return e_failure;
         }
     }
     // IF => e_decode
@@ -70,10 +175,140 @@ int main(int argc, char *argv[])
             // Validate the input CLA
             if(read_and_validate_decode_args(argv, &decodeInfo) == e_failure)
                 return e_failure;
+            if(options.keys_file && read_key_list(options.keys_file, &decodeInfo.keys, &decodeInfo.key_count) == e_failure)
+                return e_failure;
+            decodeInfo.plane_cache = options.plane_cache;
+            decodeInfo.progress.stream = progress_stream;
+            // A memfd is only worth making when something takes it over
+            decodeInfo.memfd = (options.exec_command || options.send_socket);
+            decodeInfo.handoff_command = options.exec_command;
+            decodeInfo.handoff_socket = options.send_socket;
+            if(options.memfd && !decodeInfo.memfd)
+            {
+                fprintf(stderr, "Error: --memfd needs --exec=command or --send=socket\n");
+                return e_failure;
+            }
+            if(options.secret_fd)
+            {
+                if(decodeInfo.memfd)
+                {
+                    fprintf(stderr, "Error: --fd cannot be used with --exec or --send\n");
+                    return e_failure;
+                }
+                decodeInfo.fptr_secret = fdopen(options.secret_fd, "wb");
+                if(decodeInfo.fptr_secret == NULL)
+                {
+                    perror("fdopen");
+                    fprintf(stderr, "Error: Unable to write the secret to descriptor %d\n", options.secret_fd);
+                    return e_failure;
+                }
+            }
+
+            // Start the Dencoding, then give the memfd to its consumer
+            Status ret = do_decoding(&decodeInfo);
+            if(ret == e_success && decodeInfo.memfd)
+                ret = hand_off_secret(&decodeInfo);
+            free_key_list(decodeInfo.keys, decodeInfo.key_count);
+            if(ret == e_failure)
+                return e_failure;
+        }
+    }
+    // IF => e_daemon
+    if(operation == e_daemon)
+    {
+        DaemonInfo daemonInfo = {0};
+        if(argc >= 3 && argc <= 4)
+        {
+            // Validate the input CLA
+            if(read_and_validate_daemon_args(argv, &daemonInfo) == e_failure)
+                return e_failure;
+
+            // Serve jobs until killed
+            if(do_daemon(&daemonInfo) == e_failure)
+                return e_failure;
+        }
+    }
+    // IF => e_shard_encode
+    if(operation == e_shard_encode)
+    {
+        ShardInfo shardInfo = {0};
+        if(argc >= 5)
+        {
+            shardInfo.secret_fname = argv[2];
+            shardInfo.out_prefix = argv[3];
+            shardInfo.fec_parity = options.fec_parity;
+            shardInfo.matrix_k = options.matrix_k;
+            shardInfo.verify = options.verify;
+            shardInfo.map_threads = options.map_threads;
+            shardInfo.progress_stream = progress_stream;
+            // Validate the input CLA
+            if(read_and_validate_shard_args(argc, argv, 4, &shardInfo) == e_failure)
+                return e_failure;
+
+            // Start the shard encoding
+            if(do_shard_encoding(&shardInfo) == e_failure)
+                return e_failure;
+        }
+    }
+    // IF => e_shard_decode
+    if(operation == e_shard_decode)
+    {
+        ShardInfo shardInfo = {0};
+        if(argc >= 4)
+        {
+            shardInfo.secret_fname = argv[2];
+            shardInfo.progress_stream = progress_stream;
+            // Validate the input CLA
+            if(read_and_validate_shard_args(argc, argv, 3, &shardInfo) == e_failure)
+                return e_failure;
+
+            // Start the shard decoding
+            if(do_shard_decoding(&shardInfo) == e_failure)
+                return e_failure;
+        }
+    }
+    // IF => e_fanout_encode
+    if(operation == e_fanout_encode)
+    {
+        ShardInfo shardInfo = {0};
+        if(argc >= 5)
+        {
+            shardInfo.secret_fname = argv[2];
+            shardInfo.out_prefix = argv[3];
+            shardInfo.fec_parity = options.fec_parity;
+            shardInfo.matrix_k = options.matrix_k;
+            shardInfo.verify = options.verify;
+            shardInfo.map_threads = options.map_threads;
+            shardInfo.progress_stream = progress_stream;
+            // Validate the input CLA
+            if(read_and_validate_shard_args(argc, argv, 4, &shardInfo) == e_failure)
+                return e_failure;
+            if(options.keys_file && read_key_list(options.keys_file, &shardInfo.keys, &shardInfo.key_count) == e_failure)
+                return e_failure;
 
-            // Start the Dencoding
-            do_decoding(&decodeInfo);
+            // Start the fan-out encoding
+            Status ret = do_fanout_encoding(&shardInfo);
+            free_key_list(shardInfo.keys, shardInfo.key_count);
+            if(ret == e_failure)
+                return e_failure;
+        }
+    }
+    // IF => e_benchmark
+    if(operation == e_benchmark)
+    {
+        // Default 16 MB of payload per format
+        int megabytes = (argc >= 3) ? atoi(argv[2]) : 16;
+        if(megabytes <= 0)
+        {
+            fprintf(stderr, "Error: Benchmark size should be a positive number of megabytes\n");
+            return e_failure;
         }
+        if(do_format_benchmark(megabytes) == e_failure)
+            return e_failure;
+        if(do_fec_benchmark(megabytes, options.fec_parity ? options.fec_parity : DEFAULT_FEC_PARITY) == e_failure)
+            return e_failure;
+        if(do_matrix_benchmark(megabytes, options.matrix_k ? options.matrix_k : DEFAULT_MATRIX_K) == e_failure)
+            return e_failure;
     }
     return 0; 
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+/***********************************************************************
+ *  File Name   : mapped.c
+ *  Description : Source file for the Mapped Output Module.
+ *                With --mmap the output is grown to the cover's size with
+ *                ftruncate() and both files are mapped. The header and the
+ *                payload blocks are copied from the cover mapping into the
+ *                output mapping and embedded there, so no block goes
+ *                through stdio or a bounce buffer. The rest of the image
+ *                is a plain copy, split into page aligned slices so that
+ *                several threads fault the output pages in at once. The
+ *                cover is mapped with MAP_POPULATE and read sequentially;
+ *                the output is asked for huge pages, which the page cache
+ *                of some filesystems (tmpfs) can use. The output is synced
+ *                once, after its last byte.
+ *
+ *                Functions:
+ *                - map_stego_images()
+ *                - copy_mapped_tail()
+ *                - copy_mapped_slice()
+ *                - sync_stego_map()
+ *                - unmap_stego_images()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+/* 64-bit off_t for ftruncate()/fstat() on multi-gigabyte images */
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "types.h"
+#include "encode.h"
+#include "mapped.h"
+
+Status map_stego_images(EncodeInfo *encInfo)
+{
+    struct stat st;
+    int src_fd = fileno(encInfo->fptr_src_image);
+    int stego_fd = fileno(encInfo->fptr_stego_image);
+    if(fstat(src_fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+        return e_failure;
+    // Nothing may be buffered for the output, it is written through the mapping only
+    if(fflush(encInfo->fptr_stego_image) != 0 || ftruncate(stego_fd, st.st_size) != 0)
+        return e_failure;
+
+    void *src = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, src_fd, 0);
+    if(src == MAP_FAILED)
+        return e_failure;
+    // A write only descriptor (e.g. from a daemon client) cannot be mapped
+    void *stego = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, stego_fd, 0);
+    if(stego == MAP_FAILED)
+    {
+        munmap(src, st.st_size);
+        return e_failure;
+    }
+    madvise(src, st.st_size, MADV_SEQUENTIAL);
+    madvise(stego, st.st_size, MADV_HUGEPAGE);
+    encInfo->src_map = src;
+    encInfo->stego_map = stego;
+    encInfo->map_size = st.st_size;
+    encInfo->map_pos = 0;
+    return e_success;
+}
+
+Status copy_mapped_tail(EncodeInfo *encInfo)
+{
+    MappedSlice slices[MAX_MAP_THREADS];
+    pthread_t workers[MAX_MAP_THREADS];
+    uint64_t pos = encInfo->map_pos;
+    uint64_t tail = encInfo->map_size - pos;
+    long page = sysconf(_SC_PAGESIZE);
+
+    // A thread per MAP_MIN_SLICE at most, small tails are copied in place
+    uint threads = encInfo->map_threads;
+    if(threads > tail / MAP_MIN_SLICE)
+        threads = tail / MAP_MIN_SLICE ? tail / MAP_MIN_SLICE : 1;
+    uint64_t share = (tail / threads + page - 1) / page * page;
+    for(uint i = 0; i < threads; i++)
+    {
+        // Slices end on page boundaries of the file so no page is faulted by two threads
+        uint64_t end = (i == threads - 1) ? encInfo->map_size : (pos + share) / page * page;
+        slices[i].dst = encInfo->stego_map + pos;
+        slices[i].src = encInfo->src_map + pos;
+        slices[i].len = end > pos ? end - pos : 0;
+        pos = end > pos ? end : pos;
+    }
+
+    // The calling thread takes the first slice itself
+    uint started = 1;
+    for(; started < threads; started++)
+    {
+        if(pthread_create(&workers[started], NULL, copy_mapped_slice, &slices[started]) != 0)
+            break;
+    }
+    copy_mapped_slice(&slices[0]);
+    // Slices without a thread are copied here as well
+    for(uint i = started; i < threads; i++)
+        copy_mapped_slice(&slices[i]);
+    for(uint i = 1; i < started; i++)
+        pthread_join(workers[i], NULL);
+    encInfo->map_pos = encInfo->map_size;
+    printf("Remaining Data copied by %u threads Successfully\n", threads);
+    return e_success;
+}
+
+void *copy_mapped_slice(void *arg)
+{
+    MappedSlice *slice = arg;
+    memcpy(slice->dst, slice->src, slice->len);
+    return NULL;
+}
+
+Status sync_stego_map(EncodeInfo *encInfo)
+{
+    // Dirty pages already sit in the page cache, MS_ASYNC hands them to writeback
+    // without waiting, the same durability as the stdio path's fclose()
+    if(msync(encInfo->stego_map, encInfo->map_size, MS_ASYNC) != 0)
+    {
+        perror("msync");
+        return e_failure;
+    }
+    return e_success;
+}
+
+void unmap_stego_images(EncodeInfo *encInfo)
+{
+    if(encInfo->src_map)
+        munmap((void *)encInfo->src_map, encInfo->map_size);
+    if(encInfo->stego_map)
+        munmap(encInfo->stego_map, encInfo->map_size);
+    encInfo->src_map = NULL;
+    encInfo->stego_map = NULL;
+}
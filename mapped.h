@@ -0,0 +1,61 @@
+/***********************************************************************
+ *  File Name   : mapped.h
+ *  Description : Header file for the Mapped Output Module.
+ *                Contains the definitions and function declarations used
+ *                for encoding through mmap(): the cover and the output
+ *                are mapped, blocks are embedded straight into the output
+ *                mapping, and the untouched tail is copied by several
+ *                threads at once.
+ *
+ *                Structures:
+ *                - MappedSlice
+ *
+ *                Functions:
+ *                - map_stego_images()
+ *                - copy_mapped_tail()
+ *                - copy_mapped_slice()
+ *                - sync_stego_map()
+ *                - unmap_stego_images()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef MAPPED_H
+#define MAPPED_H
+
+#include <stdint.h>
+#include "types.h"
+#include "encode.h"
+
+/* Most threads copying the tail of one image */
+#define MAX_MAP_THREADS 16
+/* Smallest share of the tail worth a thread of its own */
+#define MAP_MIN_SLICE (4 * 1024 * 1024)
+
+/* Part of the tail one thread copies */
+typedef struct _MappedSlice
+{
+    unsigned char *dst;         // => Store where the slice goes in the output mapping
+    const unsigned char *src;   // => Store where it comes from in the cover mapping
+    size_t len;                 // => Store the bytes in the slice
+
+} MappedSlice;
+
+/* Size the output like the cover and map both, fails if either can't be mapped */
+Status map_stego_images(EncodeInfo *encInfo);
+
+/* Copy everything after map_pos, split across the threads */
+Status copy_mapped_tail(EncodeInfo *encInfo);
+
+/* Thread body, copies one slice */
+void *copy_mapped_slice(void *arg);
+
+/* The one msync() of the output, after its last byte is in place */
+Status sync_stego_map(EncodeInfo *encInfo);
+
+/* Drop both mappings */
+void unmap_stego_images(EncodeInfo *encInfo);
+
+#endif
@@ -0,0 +1,208 @@
+/***********************************************************************
+ *  File Name   : matrix.c
+ *  Description : Source file for the Matrix Embedding Module.
+ *                Hamming (1, 2^k - 1, k) syndrome coding: a unit of 2^k
+ *                carrier bits carries k message bits as its syndrome and
+ *                embedding flips at most one carrier, so the expected
+ *                changes per payload byte drop from 4 (plain LSB) to
+ *                8 (1 - 2^-k) / k. Units are whole carrier bytes, which
+ *                keeps the syndrome to one table lookup per carrier byte.
+ *                Message bits are taken MSB first across byte boundaries.
+ *
+ *                Functions:
+ *                - init_matrix()
+ *                - get_matrix_carrier_size()
+ *                - get_matrix_data_capacity()
+ *                - embed_matrix_units()
+ *                - extract_matrix_units()
+ *                - do_matrix_benchmark()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "types.h"
+#include "matrix.h"
+
+/* unit_syndrome[b][v] => XOR of the indexes 8b + j of the set bits j of v */
+static unsigned char unit_syndrome[MAX_MATRIX_UNIT_BYTES][256];
+/* bit_count[v] => number of set bits in v */
+static unsigned char bit_count[256];
+static pthread_once_t matrix_once = PTHREAD_ONCE_INIT;
+
+static void init_matrix_tables(void)
+{
+    for(uint b = 0; b < MAX_MATRIX_UNIT_BYTES; b++)
+        for(uint v = 0; v < 256; v++)
+        {
+            uint s = 0;
+            for(uint j = 0; j < 8; j++)
+                if(v & (1 << j))
+                    s ^= 8 * b + j;
+            unit_syndrome[b][v] = s;
+        }
+    for(uint v = 1; v < 256; v++)
+        bit_count[v] = (v & 1) + bit_count[v >> 1];
+}
+
+static uint get_unit_syndrome(const unsigned char *unit, uint unit_bytes)
+{
+    uint s = 0;
+    for(uint b = 0; b < unit_bytes; b++)
+        s ^= unit_syndrome[b][unit[b]];
+    return s;
+}
+
+Status init_matrix(MatrixCode *code, uint k)
+{
+    if(k < MIN_MATRIX_K || k > MAX_MATRIX_K)
+    {
+        fprintf(stderr, "Error: Matrix embedding k should be between %d and %d\n", MIN_MATRIX_K, MAX_MATRIX_K);
+        return e_failure;
+    }
+    pthread_once(&matrix_once, init_matrix_tables);
+    memset(code, 0, sizeof(*code));
+    code->k = k;
+    code->unit_bytes = 1 << (k - 3);
+    return e_success;
+}
+
+uint64_t get_matrix_carrier_size(uint64_t size, uint k)
+{
+    // Last unit is zero padded
+    uint64_t units = (size * 8 + k - 1) / k;
+    return units << (k - 3);
+}
+
+uint64_t get_matrix_data_capacity(uint64_t carriers, uint k)
+{
+    uint64_t units = carriers >> (k - 3);
+    return units * k / 8;
+}
+
+size_t embed_matrix_units(MatrixCode *code, unsigned char *plane, size_t units, const unsigned char *data, size_t size)
+{
+    // Working copies, plane stores could otherwise alias the struct fields
+    uint k = code->k, unit_bytes = code->unit_bytes;
+    uint mask = (1 << k) - 1;
+    uint acc = code->acc, acc_bits = code->acc_bits;
+    uint64_t changed = 0, plain_changed = 0;
+    size_t used = 0;
+    for(size_t u = 0; u < units; u++, plane += unit_bytes)
+    {
+        // k <= 8, so one more byte always completes the message bits
+        if(acc_bits < k)
+        {
+            acc = (acc << 8) | (used < size ? data[used++] : 0);
+            acc_bits += 8;
+        }
+        acc_bits -= k;
+        uint message = (acc >> acc_bits) & mask;
+        acc &= (1 << acc_bits) - 1;
+
+        // Plain LSB would write the same k bits over k carriers of this cover
+        plain_changed += bit_count[(message ^ plane[0]) & mask];
+
+        // Flipping carrier number (syndrome ^ message) turns the syndrome into the message,
+        // carrier 0 is unused so "flipping" it when they already match is a no-op
+        uint flip = get_unit_syndrome(plane, unit_bytes) ^ message;
+        plane[flip >> 3] ^= (flip != 0) << (flip & 7);
+        changed += (flip != 0);
+    }
+    code->acc = acc;
+    code->acc_bits = acc_bits;
+    code->changed += changed;
+    code->plain_changed += plain_changed;
+    return used;
+}
+
+size_t extract_matrix_units(MatrixCode *code, const unsigned char *plane, size_t units, unsigned char *data, size_t size)
+{
+    // Working copies, data stores could otherwise alias the struct fields
+    uint k = code->k, unit_bytes = code->unit_bytes;
+    uint acc = code->acc, acc_bits = code->acc_bits;
+    size_t out = 0;
+    for(size_t u = 0; ; u++, plane += unit_bytes)
+    {
+        while(acc_bits >= 8 && out < size)
+        {
+            acc_bits -= 8;
+            data[out++] = acc >> acc_bits;
+            acc &= (1 << acc_bits) - 1;
+        }
+        if(u == units)
+            break;
+        acc = (acc << k) | get_unit_syndrome(plane, unit_bytes);
+        acc_bits += k;
+    }
+    code->acc = acc;
+    code->acc_bits = acc_bits;
+    return out;
+}
+
+static double elapsed_seconds(struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+Status do_matrix_benchmark(uint megabytes, uint k)
+{
+    MatrixCode code;
+    if(init_matrix(&code, k) == e_failure)
+        return e_failure;
+    size_t len = (size_t)megabytes * 1024 * 1024;
+    size_t carriers = get_matrix_carrier_size(len, k);
+    size_t units = carriers / code.unit_bytes;
+    unsigned char *data = malloc(len);
+    unsigned char *check = malloc(len);
+    unsigned char *plane = malloc(carriers);
+    if(data == NULL || check == NULL || plane == NULL)
+    {
+        fprintf(stderr, "Error: Unable to allocate %u MB benchmark buffers\n", megabytes);
+        free(data);
+        free(check);
+        free(plane);
+        return e_failure;
+    }
+    for(size_t i = 0; i < len; i++)
+        data[i] = (unsigned char)(i * 2654435761u >> 13);
+    for(size_t i = 0; i < carriers; i++)
+        plane[i] = (unsigned char)(i * 40503u >> 7);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    embed_matrix_units(&code, plane, units, data, len);
+    double embed_time = elapsed_seconds(&start);
+    uint64_t changed = code.changed, plain_changed = code.plain_changed;
+
+    init_matrix(&code, k);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t out = extract_matrix_units(&code, plane, units, check, len);
+    double extract_time = elapsed_seconds(&start);
+
+    Status ret = e_success;
+    if(out != len || memcmp(data, check, len) != 0)
+    {
+        fprintf(stderr, "Error: Matrix embedding does not round trip\n");
+        ret = e_failure;
+    }
+    // Rates are payload bytes per second, on carriers already pulled out of the image
+    char name[16];
+    snprintf(name, sizeof(name), "matrix-%u", k);
+    printf("%-8s %8u MB %12.1f %12.1f\n", name, megabytes, megabytes / embed_time, megabytes / extract_time);
+    printf("%-8s changes %.2f bytes per payload byte, plain LSB %.2f\n", name, (double)changed / len, (double)plain_changed / len);
+    free(data);
+    free(check);
+    free(plane);
+    return ret;
+}
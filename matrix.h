@@ -0,0 +1,71 @@
+/***********************************************************************
+ *  File Name   : matrix.h
+ *  Description : Header file for the Matrix Embedding Module.
+ *                Contains the Hamming code state and function declarations
+ *                used for hiding k message bits in 2^k carrier bits with
+ *                at most one changed carrier, instead of one per bit.
+ *
+ *                Structures:
+ *                - MatrixCode
+ *
+ *                Functions:
+ *                - init_matrix()
+ *                - get_matrix_carrier_size()
+ *                - get_matrix_data_capacity()
+ *                - embed_matrix_units()
+ *                - extract_matrix_units()
+ *                - do_matrix_benchmark()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "types.h"
+
+/* Message bits per Hamming unit, a unit spans 2^(k-3) carrier bytes */
+#define MIN_MATRIX_K 3
+#define MAX_MATRIX_K 8
+#define MAX_MATRIX_UNIT_BYTES (1 << (MAX_MATRIX_K - 3))
+
+/*
+ * The carriers are the bits the pixel format's kernels hide data in,
+ * taken 8 to a carrier byte. Carrier bit j of byte b in a unit has index
+ * 8b + j and the syndrome is the XOR of the indexes of all set carriers,
+ * so index 0 is never used and a unit holds 2^k - 1 carriers.
+ */
+typedef struct _MatrixCode
+{
+    uint k;                     // => Store message bits per unit
+    uint unit_bytes;            // => Store carrier bytes per unit
+    uint acc;                   // => Store message bits not yet in a unit
+    uint acc_bits;              // => Store how many bits acc holds
+    uint64_t changed;           // => Store carriers flipped so far
+    uint64_t plain_changed;     // => Store carriers plain LSB would have flipped
+
+} MatrixCode;
+
+/* Set up a code with k message bits per unit */
+Status init_matrix(MatrixCode *code, uint k);
+
+/* Get the carrier bytes taken by size message bytes */
+uint64_t get_matrix_carrier_size(uint64_t size, uint k);
+
+/* Get the most message bytes that fit in carrier bytes */
+uint64_t get_matrix_data_capacity(uint64_t carriers, uint k);
+
+/* Hide message bits in units whole units, zero padded once size runs out, returns bytes used */
+size_t embed_matrix_units(MatrixCode *code, unsigned char *plane, size_t units, const unsigned char *data, size_t size);
+
+/* Read units whole units into at most size bytes, spare bits wait in acc, returns bytes written */
+size_t extract_matrix_units(MatrixCode *code, const unsigned char *plane, size_t units, unsigned char *data, size_t size);
+
+/* Time embedding and extraction on random carriers */
+Status do_matrix_benchmark(uint megabytes, uint k);
+
+#endif
@@ -0,0 +1,100 @@
+/***********************************************************************
+ *  File Name   : metrics.c
+ *  Description : Source file for the Distortion Metrics Module.
+ *                The embed kernels already hold every carrier's old and
+ *                new bit, so they count the changes as they write and no
+ *                image is read again afterwards. Embedding only ever
+ *                flips a channel's LSB, so every changed sample has a
+ *                squared error of exactly 1 in that channel's units and
+ *                the MSE is the changed count over the sample count.
+ *                The channel of a carrier is taken from its place in the
+ *                pixel stream. Row padding bytes carry data too and are
+ *                counted with the channel they fall on, so for covers with
+ *                padded rows the figures include those few bytes.
+ *                Palette indexes (8 bpp) are not colour values: index^1
+ *                may be any colour of the palette, so an MSE over indexes
+ *                would mean nothing and those covers get counts only.
+ *
+ *                Functions:
+ *                - get_distortion_metrics()
+ *                - get_bmp_pixel_count()
+ *                - print_distortion_metrics()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+/* 64-bit off_t for fseeko() on multi-gigabyte images */
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "types.h"
+#include "bmp.h"
+#include "metrics.h"
+
+Status get_distortion_metrics(const BmpFormat *format, const BmpChanges *changes, uint64_t pixels, DistortionMetrics *metrics)
+{
+    memset(metrics, 0, sizeof(*metrics));
+    if(pixels == 0)
+        return e_failure;
+    metrics->samples = pixels;
+    metrics->counts_only = 0;
+    // Every carrier of a group belongs to one channel, which depends on the group's phase
+    for(uint p = 0; p < format->phases; p++)
+        for(uint n = 0; n < 8; n++)
+            metrics->changed[format->slot_channel[p][n]] += changes->slots[p][n];
+
+    // Every change is off by one in its channel, so the squared error sum is the count
+    double normalised = 0;
+    for(uint c = 0; c < format->channels; c++)
+    {
+        double peak = format->channel_peak[c];
+        metrics->total_changed += metrics->changed[c];
+        if(peak == 0)
+        {
+            metrics->counts_only = 1;
+            continue;
+        }
+        metrics->mse[c] = (double)metrics->changed[c] / pixels;
+        metrics->psnr[c] = 10 * log10(peak * peak / metrics->mse[c]);
+        normalised += metrics->mse[c] / (peak * peak);
+    }
+    if(metrics->counts_only)
+        return e_success;
+    // Channels with different peaks (16 bpp) are weighted by their own peak
+    metrics->total_mse = (double)metrics->total_changed / (pixels * format->channels);
+    metrics->total_psnr = 10 * log10(format->channels / normalised);
+    return e_success;
+}
+
+uint64_t get_bmp_pixel_count(FILE *fptr_image)
+{
+    int32_t width, height;
+    if(fseeko(fptr_image, BMP_WIDTH_POS, SEEK_SET) != 0 || fread(&width, 4, 1, fptr_image) != 1 ||
+       fread(&height, 4, 1, fptr_image) != 1)
+        return 0;
+    // Bottom up and top down images differ only in the sign of the height
+    return (uint64_t)(width < 0 ? -(int64_t)width : width) * (uint64_t)(height < 0 ? -(int64_t)height : height);
+}
+
+void print_distortion_metrics(const BmpFormat *format, const DistortionMetrics *metrics)
+{
+    if(metrics->counts_only)
+    {
+        printf("Distortion overall: %" PRIu64 " changed of %" PRIu64 " %s samples (no MSE / PSNR, palette indexes are not colours)\n",
+               metrics->total_changed, metrics->samples * format->channels, format->channel_names[0]);
+        return;
+    }
+    // No changes gives an infinite PSNR, printed as "inf"
+    for(uint c = 0; c < format->channels; c++)
+        printf("Distortion %-7s: %" PRIu64 " changed, MSE %.6f, PSNR %.2f dB\n",
+               format->channel_names[c], metrics->changed[c], metrics->mse[c], metrics->psnr[c]);
+    printf("Distortion overall: %" PRIu64 " changed of %" PRIu64 ", MSE %.6f, PSNR %.2f dB\n",
+           metrics->total_changed, metrics->samples * format->channels, metrics->total_mse, metrics->total_psnr);
+}
@@ -0,0 +1,51 @@
+/***********************************************************************
+ *  File Name   : metrics.h
+ *  Description : Header file for the Distortion Metrics Module.
+ *                Contains the structure and function declarations used
+ *                for turning the changes counted by the embed kernels
+ *                into per channel and overall changed counts, MSE and
+ *                PSNR for the run summary.
+ *
+ *                Structures:
+ *                - DistortionMetrics
+ *
+ *                Functions:
+ *                - get_distortion_metrics()
+ *                - get_bmp_pixel_count()
+ *                - print_distortion_metrics()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include "types.h"
+#include "bmp.h"
+
+typedef struct _DistortionMetrics
+{
+    uint64_t samples;                      // => Store the samples per channel (pixels)
+    uint64_t changed[BMP_MAX_CHANNELS];    // => Store the changed samples per channel
+    double mse[BMP_MAX_CHANNELS];          // => Store the MSE per channel, in channel units
+    double psnr[BMP_MAX_CHANNELS];         // => Store the PSNR per channel in dB
+    uint64_t total_changed;                // => Store the changed samples in all channels
+    double total_mse;                      // => Store the MSE over every sample
+    double total_psnr;                     // => Store the PSNR over every sample in dB
+    uint counts_only;                      // => Store 1 when the samples are not colours (palette), no MSE / PSNR
+
+} DistortionMetrics;
+
+/* Fold the kernels' change counts into the metrics of an image of pixels pixels */
+Status get_distortion_metrics(const BmpFormat *format, const BmpChanges *changes, uint64_t pixels, DistortionMetrics *metrics);
+
+/* Get width x height from the BMP header */
+uint64_t get_bmp_pixel_count(FILE *fptr_image);
+
+/* Print the metrics as part of the run summary */
+void print_distortion_metrics(const BmpFormat *format, const DistortionMetrics *metrics);
+
+#endif
@@ -0,0 +1,248 @@
+/***********************************************************************
+ *  File Name   : options.c
+ *  Description : Source file for the Command Line Options Module.
+ *                Optional switches may appear anywhere after the
+ *                operation; they are removed from argv so the encode and
+ *                decode argument checks only ever see positional args.
+ *
+ *                Every operation then accepts only the switches it uses,
+ *                so a misplaced one (--matrix on a decode, say) fails
+ *                instead of silently doing nothing.
+ *
+ *                Functions:
+ *                - read_options()
+ *                - get_operation_options()
+ *                - check_options()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "types.h"
+#include "options.h"
+#include "fec.h"
+#include "matrix.h"
+#include "encode.h"
+#include "cache.h"
+#include "mapped.h"
+
+Status read_options(int *argc, char *argv[], Options *options)
+{
+    int kept = 2;
+    // argv[0] is the program and argv[1] the operation, both always kept
+    for(int i = 2; i < *argc; i++)
+    {
+        if(strncmp(argv[i], "--", 2) != 0)
+        {
+            argv[kept++] = argv[i];
+            continue;
+        }
+        char *value = strchr(argv[i], '=');
+        size_t name_len = value ? (size_t)(value - argv[i]) : strlen(argv[i]);
+        if(value)
+            value++;
+
+        if(name_len == 5 && strncmp(argv[i], "--fec", 5) == 0)
+        {
+            options->given |= OPTION_FEC;
+            options->fec_parity = value ? atoi(value) : DEFAULT_FEC_PARITY;
+            if(options->fec_parity < MIN_FEC_PARITY || options->fec_parity > MAX_FEC_PARITY)
+            {
+                fprintf(stderr, "Error: FEC parity should be between %d and %d bytes\n", MIN_FEC_PARITY, MAX_FEC_PARITY);
+                return e_failure;
+            }
+        }
+        else if(name_len == 8 && strncmp(argv[i], "--matrix", 8) == 0)
+        {
+            options->given |= OPTION_MATRIX;
+            options->matrix_k = value ? atoi(value) : DEFAULT_MATRIX_K;
+            if(options->matrix_k < MIN_MATRIX_K || options->matrix_k > MAX_MATRIX_K)
+            {
+                fprintf(stderr, "Error: Matrix embedding k should be between %d and %d\n", MIN_MATRIX_K, MAX_MATRIX_K);
+                return e_failure;
+            }
+        }
+        else if(name_len == 8 && strncmp(argv[i], "--verify", 8) == 0)
+        {
+            options->given |= OPTION_VERIFY;
+            // Plain --verify reads the blocks back, =digest also checks the written file
+            if(value == NULL)
+                options->verify = VERIFY_BLOCKS;
+            else if(strcmp(value, "digest") == 0)
+                options->verify = VERIFY_DIGEST;
+            else
+            {
+                fprintf(stderr, "Error: Invalid verify level \"%s\", use --verify or --verify=digest\n", value);
+                return e_failure;
+            }
+        }
+        else if(name_len == 7 && strncmp(argv[i], "--cache", 7) == 0)
+        {
+            options->given |= OPTION_CACHE;
+            if(value == NULL || *value == '\0')
+            {
+                fprintf(stderr, "Error: --cache needs a directory, use --cache=dir\n");
+                return e_failure;
+            }
+            options->cache_dir = value;
+        }
+        else if(name_len == 12 && strncmp(argv[i], "--cache-size", 12) == 0)
+        {
+            options->given |= OPTION_CACHE_SIZE;
+            options->cache_mb = value ? atoi(value) : 0;
+            if(options->cache_mb == 0)
+            {
+                fprintf(stderr, "Error: Cache size should be a positive number of megabytes\n");
+                return e_failure;
+            }
+        }
+        else if(name_len == 6 && strncmp(argv[i], "--keys", 6) == 0)
+        {
+            options->given |= OPTION_KEYS;
+            if(value == NULL || *value == '\0')
+            {
+                fprintf(stderr, "Error: --keys needs a file, use --keys=file\n");
+                return e_failure;
+            }
+            options->keys_file = value;
+        }
+        else if(name_len == 7 && strncmp(argv[i], "--plane", 7) == 0 && value == NULL)
+        {
+            options->given |= OPTION_PLANE;
+            options->plane_cache = 1;
+        }
+        else if(name_len == 11 && strncmp(argv[i], "--pool-size", 11) == 0)
+        {
+            options->given |= OPTION_POOL_SIZE;
+            options->pool_mb = value ? atoi(value) : 0;
+            if(options->pool_mb == 0)
+            {
+                fprintf(stderr, "Error: Pool size should be a positive number of megabytes\n");
+                return e_failure;
+            }
+        }
+        else if(name_len == 12 && strncmp(argv[i], "--huge-pages", 12) == 0 && value == NULL)
+        {
+            options->given |= OPTION_HUGE_PAGES;
+            options->huge_pages = 1;
+        }
+        else if(name_len == 10 && strncmp(argv[i], "--progress", 10) == 0)
+        {
+            options->given |= OPTION_PROGRESS;
+            options->progress = 1;
+            options->progress_fd = value ? atoi(value) : STDERR_FILENO;
+            if(options->progress_fd < 1)
+            {
+                fprintf(stderr, "Error: Progress descriptor should be 1 or above, use --progress[=fd]\n");
+                return e_failure;
+            }
+        }
+        else if(name_len == 7 && strncmp(argv[i], "--memfd", 7) == 0 && value == NULL)
+        {
+            options->given |= OPTION_MEMFD;
+            options->memfd = 1;
+        }
+        else if(name_len == 6 && strncmp(argv[i], "--exec", 6) == 0)
+        {
+            options->given |= OPTION_EXEC;
+            if(value == NULL || *value == '\0')
+            {
+                fprintf(stderr, "Error: --exec needs a command, use --exec=command\n");
+                return e_failure;
+            }
+            options->exec_command = value;
+        }
+        else if(name_len == 6 && strncmp(argv[i], "--send", 6) == 0)
+        {
+            options->given |= OPTION_SEND;
+            if(value == NULL || *value == '\0')
+            {
+                fprintf(stderr, "Error: --send needs a Unix socket, use --send=socket\n");
+                return e_failure;
+            }
+            options->send_socket = value;
+        }
+        else if(name_len == 4 && strncmp(argv[i], "--fd", 4) == 0)
+        {
+            options->given |= OPTION_FD;
+            // 0 to 2 are the prompt and the messages
+            options->secret_fd = value ? atoi(value) : 0;
+            if(options->secret_fd < 3)
+            {
+                fprintf(stderr, "Error: Output descriptor should be 3 or above, use --fd=N\n");
+                return e_failure;
+            }
+        }
+        else if(name_len == 6 && strncmp(argv[i], "--mmap", 6) == 0)
+        {
+            options->given |= OPTION_MMAP;
+            // More threads than CPUs would only take turns faulting pages in
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            options->map_threads = value ? atoi(value) : (cpus > 0 && cpus < DEFAULT_MAP_THREADS ? cpus : DEFAULT_MAP_THREADS);
+            if(options->map_threads < 1 || options->map_threads > MAX_MAP_THREADS)
+            {
+                fprintf(stderr, "Error: Mapped copy threads should be between 1 and %d\n", MAX_MAP_THREADS);
+                return e_failure;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Error: Unknown option => %s\n", argv[i]);
+            return e_failure;
+        }
+    }
+    *argc = kept;
+    argv[kept] = NULL;
+    return e_success;
+}
+
+uint get_operation_options(OperationType operation)
+{
+    switch(operation)
+    {
+        case e_encode:
+            return ENCODE_OPTIONS;
+        case e_decode:
+            return DECODE_OPTIONS;
+        case e_daemon:
+            return DAEMON_OPTIONS;
+        case e_shard_encode:
+            return SHARD_OPTIONS;
+        case e_shard_decode:
+            return REBUILD_OPTIONS;
+        case e_fanout_encode:
+            return FANOUT_OPTIONS;
+        case e_benchmark:
+            return BENCHMARK_OPTIONS;
+        default:
+            return 0;
+    }
+}
+
+Status check_options(const Options *options, uint allowed, const char *operation)
+{
+    // Same order as the OPTION_* bits
+    static const char *names[] = { "--fec", "--matrix", "--verify", "--cache", "--cache-size", "--keys", "--plane", "--pool-size",
+                                   "--huge-pages", "--mmap", "--progress", "--memfd", "--exec", "--send", "--fd" };
+    for(uint bit = 0; bit < sizeof(names) / sizeof(names[0]); bit++)
+    {
+        if((options->given & ~allowed) & (1u << bit))
+        {
+            fprintf(stderr, "Error: %s cannot be used with %s\n", names[bit], operation);
+            return e_failure;
+        }
+    }
+    // A size is meaningless without the cache it limits
+    if((options->given & OPTION_CACHE_SIZE) && !(options->given & OPTION_CACHE))
+    {
+        fprintf(stderr, "Error: --cache-size needs --cache=dir\n");
+        return e_failure;
+    }
+    return e_success;
+}
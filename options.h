@@ -0,0 +1,97 @@
+/***********************************************************************
+ *  File Name   : options.h
+ *  Description : Header file for the Command Line Options Module.
+ *                Contains the structure holding the optional "--name"
+ *                switches, the switches each operation accepts, and the
+ *                declarations of the functions that pull them out of argv,
+ *                leaving the positional arguments, and check them against
+ *                the operation.
+ *
+ *                Structures:
+ *                - Options
+ *
+ *                Functions:
+ *                - read_options()
+ *                - get_operation_options()
+ *                - check_options()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "types.h"
+
+/* Parity bytes per codeword when --fec is given without a value */
+#define DEFAULT_FEC_PARITY 16
+/* Message bits per Hamming unit when --matrix is given without a value */
+#define DEFAULT_MATRIX_K 4
+/* Tail copy threads when --mmap is given without a value, capped by the CPUs online */
+#define DEFAULT_MAP_THREADS 4
+
+/* One bit per switch, set in Options.given when it appears */
+#define OPTION_FEC          (1u << 0)
+#define OPTION_MATRIX       (1u << 1)
+#define OPTION_VERIFY       (1u << 2)
+#define OPTION_CACHE        (1u << 3)
+#define OPTION_CACHE_SIZE   (1u << 4)
+#define OPTION_KEYS         (1u << 5)
+#define OPTION_PLANE        (1u << 6)
+#define OPTION_POOL_SIZE    (1u << 7)
+#define OPTION_HUGE_PAGES   (1u << 8)
+#define OPTION_MMAP         (1u << 9)
+#define OPTION_PROGRESS     (1u << 10)
+#define OPTION_MEMFD        (1u << 11)
+#define OPTION_EXEC         (1u << 12)
+#define OPTION_SEND         (1u << 13)
+#define OPTION_FD           (1u << 14)
+
+/* Switches each operation uses, any other one is an error rather than ignored */
+#define JOB_OPTIONS         (OPTION_POOL_SIZE | OPTION_HUGE_PAGES | OPTION_PROGRESS)
+#define EMBED_OPTIONS       (OPTION_FEC | OPTION_MATRIX | OPTION_VERIFY | OPTION_MMAP)
+#define ENCODE_OPTIONS      (JOB_OPTIONS | EMBED_OPTIONS | OPTION_CACHE | OPTION_CACHE_SIZE)
+#define DECODE_OPTIONS      (JOB_OPTIONS | OPTION_KEYS | OPTION_PLANE | OPTION_MEMFD | OPTION_EXEC | OPTION_SEND | OPTION_FD)
+#define DAEMON_OPTIONS      (OPTION_POOL_SIZE | OPTION_HUGE_PAGES)
+#define SHARD_OPTIONS       (JOB_OPTIONS | EMBED_OPTIONS)
+#define REBUILD_OPTIONS     (JOB_OPTIONS)
+#define FANOUT_OPTIONS      (JOB_OPTIONS | EMBED_OPTIONS | OPTION_KEYS)
+#define BENCHMARK_OPTIONS   (OPTION_FEC | OPTION_MATRIX)
+/* Daemon requests share the daemon's pool and never hand the secret on themselves */
+#define DAEMON_ENCODE_OPTIONS (ENCODE_OPTIONS & ~(OPTION_POOL_SIZE | OPTION_HUGE_PAGES))
+#define DAEMON_DECODE_OPTIONS (OPTION_PROGRESS | OPTION_MEMFD)
+
+typedef struct _Options
+{
+    uint fec_parity;            // => --fec[=parity] : Reed-Solomon parity bytes, 0 => off
+    uint matrix_k;              // => --matrix[=k] : Hamming matrix embedding, 0 => plain LSB
+    uint verify;                // => --verify[=digest] : VERIFY_* level, 0 => off
+    char *cache_dir;            // => --cache=dir : result cache directory, NULL => off
+    uint cache_mb;              // => --cache-size=MB : most megabytes the cache may hold
+    char *keys_file;            // => --keys=file : candidate magic strings, NULL => prompt
+    uint plane_cache;           // => --plane : keep the stego image's LSB plane in "<image>.lsb"
+    uint pool_mb;               // => --pool-size=MB : I/O buffer pool shared by all jobs, 0 => default
+    uint huge_pages;            // => --huge-pages : back the buffer pool with huge pages
+    uint map_threads;           // => --mmap[=threads] : encode through mappings of the images, 0 => stdio
+    uint progress;              // => --progress[=fd] : report progress lines while jobs run
+    int progress_fd;            // => Store the descriptor the lines go to (default stderr)
+    uint memfd;                 // => --memfd : decode into a sealed memfd (daemon requests)
+    char *exec_command;         // => --exec=command : decode into a memfd and run command on it
+    char *send_socket;          // => --send=socket : decode into a memfd and send it over socket
+    int secret_fd;              // => --fd=N : decode into the inherited descriptor N, 0 => none
+    uint given;                 // => Store the OPTION_* bits of every switch seen
+
+} Options;
+
+/* Read "--name[=value]" switches and remove them from argv */
+Status read_options(int *argc, char *argv[], Options *options);
+
+/* OPTION_* bits the command line operation accepts */
+uint get_operation_options(OperationType operation);
+
+/* Fail on any switch outside allowed, naming it and the operation */
+Status check_options(const Options *options, uint allowed, const char *operation);
+
+#endif
@@ -0,0 +1,226 @@
+/***********************************************************************
+ *  File Name   : plane.c
+ *  Description : Source file for the LSB Plane Module.
+ *                The plane is every payload byte of the image, i.e. the
+ *                LSBs of the carrier bytes packed 8 to a byte, so it is
+ *                1/8 of the pixel data (less for 16 and 32 bpp). It is
+ *                pulled out once with the format's extract kernel, after
+ *                which checking a candidate magic string is a memcmp()
+ *                at offset 0 and the header and data are decoded from
+ *                memory. With --plane the plane is also kept in
+ *                "<image>.lsb", tagged with the image's device, inode,
+ *                size and mtime, so later runs skip the extraction too.
+ *
+ *                Functions:
+ *                - load_lsb_plane()
+ *                - extract_lsb_plane()
+ *                - read_lsb_plane_file()
+ *                - write_lsb_plane_file()
+ *                - read_key_list()
+ *                - free_key_list()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+/* 64-bit off_t for fseeko()/fstat() on multi-gigabyte images */
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "types.h"
+#include "decode.h"
+#include "plane.h"
+
+Status load_lsb_plane(DecodeInfo *decInfo)
+{
+    struct stat st;
+    if(fstat(fileno(decInfo->fptr_stego_image), &st) != 0)
+    {
+        perror("fstat");
+        return e_failure;
+    }
+    if((uint64_t)st.st_size < decInfo->pixel_offset)
+    {
+        fprintf(stderr, "Error: No pixel data in %s\n", decInfo->stego_image_fname);
+        return e_failure;
+    }
+    // Whole groups of the pixel data, a partial group at the end carries nothing
+    decInfo->plane_size = (st.st_size - decInfo->pixel_offset) / decInfo->format->group_size;
+    decInfo->plane_pos = 0;
+    if(!decInfo->plane_cache)
+        return extract_lsb_plane(decInfo);
+
+    PlaneHeader header = {0};
+    memcpy(header.magic, PLANE_FILE_MAGIC, sizeof(header.magic));
+    header.image_dev = st.st_dev;
+    header.image_ino = st.st_ino;
+    header.image_size = st.st_size;
+    header.image_mtime_sec = st.st_mtim.tv_sec;
+    header.image_mtime_nsec = st.st_mtim.tv_nsec;
+    header.pixel_offset = decInfo->pixel_offset;
+    header.group_size = decInfo->format->group_size;
+    header.plane_size = decInfo->plane_size;
+
+    char fname[PATH_MAX];
+    if(snprintf(fname, sizeof(fname), "%s%s", decInfo->stego_image_fname, PLANE_FILE_SUFFIX) >= (int)sizeof(fname))
+        return extract_lsb_plane(decInfo);
+    if(read_lsb_plane_file(fname, &header, decInfo) == e_success)
+    {
+        printf("LSB Plane of %" PRIu64 " bytes loaded from \"%s\" Successfully\n", decInfo->plane_size, fname);
+        return e_success;
+    }
+    if(extract_lsb_plane(decInfo) == e_failure)
+        return e_failure;
+    // A plane that cannot be kept only costs the next run an extraction
+    if(write_lsb_plane_file(fname, &header, st.st_mode, decInfo) == e_failure)
+        fprintf(stderr, "Error: Unable to save LSB Plane to \"%s\"\n", fname);
+    else
+        printf("LSB Plane saved to \"%s\" Successfully\n", fname);
+    return e_success;
+}
+
+Status extract_lsb_plane(DecodeInfo *decInfo)
+{
+    // Block buffer holding whole groups of image bytes
+    unsigned char image_buffer[MAX_CHUNK_SIZE];
+    const BmpFormat *format = decInfo->format;
+    uint64_t per_block = MAX_CHUNK_SIZE / format->group_size;
+
+    decInfo->plane = malloc(decInfo->plane_size ? decInfo->plane_size : 1);
+    if(decInfo->plane == NULL)
+    {
+        fprintf(stderr, "Error: Unable to allocate %" PRIu64 " bytes for the LSB Plane\n", decInfo->plane_size);
+        return e_failure;
+    }
+    fseeko(decInfo->fptr_stego_image, decInfo->pixel_offset, SEEK_SET);
+    for(uint64_t done = 0; done < decInfo->plane_size; )
+    {
+        uint64_t left = decInfo->plane_size - done;
+        size_t count = left < per_block ? left : per_block;
+        if(fread(image_buffer, count * format->group_size, 1, decInfo->fptr_stego_image) != 1)
+        {
+            fprintf(stderr, "Error: Failed to read pixel data from %s\n", decInfo->stego_image_fname);
+            return e_failure;
+        }
+        format->extract(image_buffer, decInfo->plane + done, count);
+        done += count;
+    }
+    printf("LSB Plane of %" PRIu64 " bytes extracted Successfully\n", decInfo->plane_size);
+    return e_success;
+}
+
+Status read_lsb_plane_file(const char *fname, const PlaneHeader *want, DecodeInfo *decInfo)
+{
+    PlaneHeader header;
+    FILE *fptr = fopen(fname, "rb");
+    if(fptr == NULL)
+        return e_failure;
+    // Stale once the image is replaced or rewritten in any way
+    if(fread(&header, sizeof(header), 1, fptr) != 1 || memcmp(&header, want, sizeof(header)) != 0)
+    {
+        fclose(fptr);
+        return e_failure;
+    }
+    decInfo->plane = malloc(header.plane_size ? header.plane_size : 1);
+    if(decInfo->plane == NULL || (header.plane_size && fread(decInfo->plane, header.plane_size, 1, fptr) != 1))
+    {
+        free(decInfo->plane);
+        decInfo->plane = NULL;
+        fclose(fptr);
+        return e_failure;
+    }
+    fclose(fptr);
+    return e_success;
+}
+
+Status write_lsb_plane_file(const char *fname, const PlaneHeader *header, mode_t mode, DecodeInfo *decInfo)
+{
+    char tmp[PATH_MAX];
+    if(snprintf(tmp, sizeof(tmp), "%s.XXXXXX", fname) >= (int)sizeof(tmp))
+        return e_failure;
+    int fd = mkstemp(tmp);
+    if(fd < 0)
+        return e_failure;
+    // The plane holds everything hidden in the image, so it is readable by
+    // exactly those who can read the image
+    fchmod(fd, mode & 0666);
+    FILE *fptr = fdopen(fd, "wb");
+    if(fptr == NULL)
+    {
+        close(fd);
+        unlink(tmp);
+        return e_failure;
+    }
+    // Readers never see a half written plane, the rename is the commit
+    int ok = fwrite(header, sizeof(*header), 1, fptr) == 1 &&
+             (decInfo->plane_size == 0 || fwrite(decInfo->plane, decInfo->plane_size, 1, fptr) == 1);
+    if(fclose(fptr) != 0 || !ok || rename(tmp, fname) != 0)
+    {
+        unlink(tmp);
+        return e_failure;
+    }
+    return e_success;
+}
+
+Status read_key_list(const char *fname, char ***keys, uint *key_count)
+{
+    char line[256];
+    FILE *fptr = fopen(fname, "r");
+    if(fptr == NULL)
+    {
+        fprintf(stderr, "ERROR: No key list found with name \"%s\"\n", fname);
+        return e_failure;
+    }
+    *keys = NULL;
+    *key_count = 0;
+    while(fgets(line, sizeof(line), fptr) != NULL)
+    {
+        // One key per line, blank lines are skipped
+        line[strcspn(line, "\r\n")] = '\0';
+        size_t len = strlen(line);
+        if(len == 0)
+            continue;
+        if(len > MAX_KEY_LEN)
+        {
+            fprintf(stderr, "Error: Key on line %u of \"%s\" is longer than %d characters\n", *key_count + 1, fname, MAX_KEY_LEN);
+            goto fail;
+        }
+        char **grown = realloc(*keys, (*key_count + 1) * sizeof(char *));
+        if(grown == NULL)
+            goto fail;
+        *keys = grown;
+        if(((*keys)[*key_count] = strdup(line)) == NULL)
+            goto fail;
+        (*key_count)++;
+    }
+    fclose(fptr);
+    if(*key_count == 0)
+    {
+        fprintf(stderr, "Error: No keys in \"%s\"\n", fname);
+        return e_failure;
+    }
+    printf("%u candidate keys read Successfully\n", *key_count);
+    return e_success;
+
+fail:
+    fclose(fptr);
+    free_key_list(*keys, *key_count);
+    *keys = NULL;
+    *key_count = 0;
+    return e_failure;
+}
+
+void free_key_list(char **keys, uint key_count)
+{
+    for(uint i = 0; i < key_count; i++)
+        free(keys[i]);
+    free(keys);
+}
@@ -0,0 +1,73 @@
+/***********************************************************************
+ *  File Name   : plane.h
+ *  Description : Header file for the LSB Plane Module.
+ *                Contains the definitions and function declarations used
+ *                for pulling every payload byte out of a stego image in
+ *                one pass, keeping it next to the image, and trying a
+ *                list of candidate magic strings against it.
+ *
+ *                Structures:
+ *                - PlaneHeader
+ *
+ *                Functions:
+ *                - load_lsb_plane()
+ *                - extract_lsb_plane()
+ *                - read_lsb_plane_file()
+ *                - write_lsb_plane_file()
+ *                - read_key_list()
+ *                - free_key_list()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef PLANE_H
+#define PLANE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "types.h"
+#include "decode.h"
+
+/* Persisted planes are "<image>.lsb" */
+#define PLANE_FILE_SUFFIX ".lsb"
+#define PLANE_FILE_MAGIC "STEGLSB1"
+/* Longest candidate key, the same limit as the typed in magic string */
+#define MAX_KEY_LEN MAX_MAGIC_LEN
+
+/* Start of a ".lsb" file, the plane is only reused while the image matches */
+typedef struct _PlaneHeader
+{
+    char magic[8];              // => Store PLANE_FILE_MAGIC
+    uint64_t image_dev;         // => Store the image's device
+    uint64_t image_ino;         // => Store the image's inode
+    uint64_t image_size;        // => Store the image's size in bytes
+    int64_t image_mtime_sec;    // => Store the image's modification time
+    int64_t image_mtime_nsec;
+    uint32_t pixel_offset;      // => Store where the pixel data starts
+    uint32_t group_size;        // => Store the image bytes per payload byte
+    uint64_t plane_size;        // => Store the payload bytes that follow
+
+} PlaneHeader;
+
+/* Fill decInfo->plane, from "<image>.lsb" when it is current */
+Status load_lsb_plane(DecodeInfo *decInfo);
+
+/* Pull every payload byte out of the pixel data, a block at a time */
+Status extract_lsb_plane(DecodeInfo *decInfo);
+
+/* Read a persisted plane, fails unless it was taken from the image in want */
+Status read_lsb_plane_file(const char *fname, const PlaneHeader *want, DecodeInfo *decInfo);
+
+/* Persist the plane with the image's permissions (mode), written to a temp
+   file and renamed into place */
+Status write_lsb_plane_file(const char *fname, const PlaneHeader *header, mode_t mode, DecodeInfo *decInfo);
+
+/* Read candidate magic strings, one per line */
+Status read_key_list(const char *fname, char ***keys, uint *key_count);
+
+/* Free what read_key_list() allocated */
+void free_key_list(char **keys, uint key_count);
+
+#endif
@@ -0,0 +1,235 @@
+/***********************************************************************
+ *  File Name   : pool.c
+ *  Description : Source file for the Buffer Pool Module.
+ *                The pool is one mmap()ed slab cut into POOL_BUFFER_SIZE
+ *                buffers, page aligned since the slab is. Free buffers are
+ *                chained through their own first bytes, so the pool needs
+ *                no memory of its own beyond the slab. A job takes all
+ *                JOB_BUFFERS of its buffers in one step, which keeps jobs
+ *                that wait for a short pool from holding part of it, and
+ *                the slab size is the cap on the I/O memory of every job
+ *                running at once.
+ *                With --huge-pages the slab is asked for with MAP_HUGETLB,
+ *                falling back to transparent huge pages when none are
+ *                reserved.
+ *                Allocation counts are instrumentation, only built with
+ *                -DSTEGO_COUNT_ALLOCS and linked with the allocator calls
+ *                wrapped (-Wl,--wrap=malloc,...): the wrappers count per
+ *                thread and hand on to the real functions, and a job's
+ *                count is the difference between two readings on the
+ *                thread it runs on. Normal builds leave the allocator
+ *                alone and report nothing.
+ *
+ *                Functions:
+ *                - set_buffer_pool_limits()
+ *                - map_buffer_pool()
+ *                - acquire_job_context()
+ *                - release_job_context()
+ *                - set_job_buffer()
+ *                - mark_job_data_pass()
+ *                - print_job_allocations()
+ *                - get_thread_allocations()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "types.h"
+#include "pool.h"
+
+/* Pool shared by every job of the process */
+static struct
+{
+    pthread_once_t once;
+    pthread_mutex_t lock;
+    pthread_cond_t freed;       // => Signalled when a job gives its buffers back
+    uint pool_mb;               // => Store the slab size in megabytes
+    uint huge_pages;            // => Store whether huge pages were asked for
+    unsigned char *slab;        // => Store the mapping, NULL => stdio's own buffers
+    size_t slab_size;
+    void *free_list;            // => Store the first free buffer, each holds the next
+    uint free_count;
+
+} pool = { PTHREAD_ONCE_INIT, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, DEFAULT_POOL_MB, 0, NULL, 0, NULL, 0 };
+
+void set_buffer_pool_limits(uint pool_mb, uint huge_pages)
+{
+    if(pool_mb)
+        pool.pool_mb = pool_mb;
+    pool.huge_pages = huge_pages;
+}
+
+void map_buffer_pool(void)
+{
+    size_t size = (size_t)pool.pool_mb << 20;
+    void *slab = MAP_FAILED;
+    const char *kind = "";
+
+    if(pool.huge_pages)
+    {
+        size = (size + POOL_HUGE_PAGE_SIZE - 1) / POOL_HUGE_PAGE_SIZE * POOL_HUGE_PAGE_SIZE;
+        slab = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        kind = " on huge pages";
+    }
+    if(slab == MAP_FAILED)
+    {
+        slab = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(slab == MAP_FAILED)
+        {
+            perror("mmap");
+            fprintf(stderr, "Error: Unable to map a %u MB Buffer Pool, files use stdio's own buffers\n", pool.pool_mb);
+            return;
+        }
+        // No reserved huge pages, transparent ones are the next best
+        if(pool.huge_pages && madvise(slab, size, MADV_HUGEPAGE) == 0)
+            kind = " on transparent huge pages";
+        else
+            kind = "";
+    }
+    pool.slab = slab;
+    pool.slab_size = size;
+
+    // Threading the free list back to front so buffers go out in address order
+    for(size_t off = size / POOL_BUFFER_SIZE * POOL_BUFFER_SIZE; off > 0; off -= POOL_BUFFER_SIZE)
+    {
+        void **buffer = (void **)(pool.slab + off - POOL_BUFFER_SIZE);
+        *buffer = pool.free_list;
+        pool.free_list = buffer;
+        pool.free_count++;
+    }
+    printf("Buffer Pool of %u buffers%s mapped Successfully\n", pool.free_count, kind);
+}
+
+Status acquire_job_context(JobContext *ctx)
+{
+    memset(ctx->buffers, 0, sizeof(ctx->buffers));
+    ctx->allocations_start = get_thread_allocations();
+    ctx->data_pass = 0;
+    pthread_once(&pool.once, map_buffer_pool);
+    // A pool too small for a single job would never be able to serve one
+    if(pool.slab == NULL || pool.slab_size / POOL_BUFFER_SIZE < JOB_BUFFERS)
+        return e_failure;
+
+    pthread_mutex_lock(&pool.lock);
+    while(pool.free_count < JOB_BUFFERS)
+        pthread_cond_wait(&pool.freed, &pool.lock);
+    for(uint i = 0; i < JOB_BUFFERS; i++)
+    {
+        ctx->buffers[i] = pool.free_list;
+        pool.free_list = *(void **)pool.free_list;
+    }
+    pool.free_count -= JOB_BUFFERS;
+    pthread_mutex_unlock(&pool.lock);
+    return e_success;
+}
+
+void release_job_context(JobContext *ctx)
+{
+    if(ctx->buffers[0] == NULL)
+        return;
+    pthread_mutex_lock(&pool.lock);
+    for(uint i = 0; i < JOB_BUFFERS; i++)
+    {
+        *(void **)ctx->buffers[i] = pool.free_list;
+        pool.free_list = ctx->buffers[i];
+        ctx->buffers[i] = NULL;
+    }
+    pool.free_count += JOB_BUFFERS;
+    pthread_cond_broadcast(&pool.freed);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+void set_job_buffer(FILE *fptr, JobContext *ctx, uint index)
+{
+    // Without a buffer stdio allocates one on the first read or write
+    if(fptr != NULL && ctx->buffers[index] != NULL)
+        setvbuf(fptr, (char *)ctx->buffers[index], _IOFBF, POOL_BUFFER_SIZE);
+}
+
+void mark_job_data_pass(JobContext *ctx)
+{
+    ctx->allocations_data = get_thread_allocations();
+    ctx->data_pass = 1;
+}
+
+void print_job_allocations(const JobContext *ctx)
+{
+#ifdef STEGO_COUNT_ALLOCS
+    uint64_t now = get_thread_allocations();
+    if(ctx->data_pass)
+        printf("Heap allocations: %" PRIu64 " for the job, %" PRIu64 " in the data pass\n",
+               now - ctx->allocations_start, now - ctx->allocations_data);
+    else
+        printf("Heap allocations: %" PRIu64 " for the job\n", now - ctx->allocations_start);
+#else
+    (void)ctx;
+#endif
+}
+
+#ifdef STEGO_COUNT_ALLOCS
+/* The real functions, under the names --wrap gives them */
+extern void *__real_malloc(size_t size);
+extern void *__real_calloc(size_t count, size_t size);
+extern void *__real_realloc(void *ptr, size_t size);
+extern int __real_posix_memalign(void **ptr, size_t align, size_t size);
+extern void *__real_aligned_alloc(size_t align, size_t size);
+extern char *__real_strdup(const char *str);
+
+/* Counted per thread so concurrent jobs don't see each other's allocations */
+static __thread uint64_t thread_allocations;
+
+void *__wrap_malloc(size_t size)
+{
+    thread_allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    thread_allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    thread_allocations++;
+    return __real_realloc(ptr, size);
+}
+
+int __wrap_posix_memalign(void **ptr, size_t align, size_t size)
+{
+    thread_allocations++;
+    return __real_posix_memalign(ptr, align, size);
+}
+
+void *__wrap_aligned_alloc(size_t align, size_t size)
+{
+    thread_allocations++;
+    return __real_aligned_alloc(align, size);
+}
+
+char *__wrap_strdup(const char *str)
+{
+    thread_allocations++;
+    return __real_strdup(str);
+}
+
+uint64_t get_thread_allocations(void)
+{
+    return thread_allocations;
+}
+#else
+uint64_t get_thread_allocations(void)
+{
+    // Not counted in normal builds
+    return 0;
+}
+#endif
@@ -0,0 +1,82 @@
+/***********************************************************************
+ *  File Name   : pool.h
+ *  Description : Header file for the Buffer Pool Module.
+ *                Contains the definitions and function declarations used
+ *                for handing every job page aligned I/O buffers out of one
+ *                preallocated (optionally huge page) slab, so jobs in batch
+ *                and daemon mode stop allocating per file and the memory
+ *                they use is capped, and for counting each job's heap
+ *                allocations.
+ *
+ *                Structures:
+ *                - JobContext
+ *
+ *                Functions:
+ *                - set_buffer_pool_limits()
+ *                - map_buffer_pool()
+ *                - acquire_job_context()
+ *                - release_job_context()
+ *                - set_job_buffer()
+ *                - mark_job_data_pass()
+ *                - print_job_allocations()
+ *                - get_thread_allocations()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "types.h"
+
+/* One stdio buffer, the same size as the block buffers (MAX_CHUNK_SIZE) */
+#define POOL_BUFFER_SIZE (64 * 1024)
+/* Buffers a job holds: source image, secret and stego image */
+#define JOB_BUFFERS 3
+#define JOB_BUFFER_SRC 0
+#define JOB_BUFFER_SECRET 1
+#define JOB_BUFFER_STEGO 2
+/* Pool size when --pool-size is not given, room for DAEMON_MAX_THREADS jobs */
+#define DEFAULT_POOL_MB 16
+/* Huge page slabs are rounded up to this */
+#define POOL_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/* What one job took from the pool, embedded in EncodeInfo / DecodeInfo */
+typedef struct _JobContext
+{
+    unsigned char *buffers[JOB_BUFFERS]; // => Store the job's stdio buffers (NULL => stdio's own)
+    uint64_t allocations_start; // => Store the thread's allocation count when the job began
+    uint64_t allocations_data;  // => Store the thread's allocation count when the data pass began
+    uint data_pass;             // => Store 1 once the job got to its data pass
+
+} JobContext;
+
+/* Size the pool and choose huge pages, before the first job */
+void set_buffer_pool_limits(uint pool_mb, uint huge_pages);
+
+/* Map the slab and thread every buffer onto the free list, once */
+void map_buffer_pool(void);
+
+/* Take all of a job's buffers at once, waiting while the pool is short */
+Status acquire_job_context(JobContext *ctx);
+
+/* Give the job's buffers back, after its files are closed */
+void release_job_context(JobContext *ctx);
+
+/* Make a pool buffer the stdio buffer of a file no I/O has been done on */
+void set_job_buffer(FILE *fptr, JobContext *ctx, uint index);
+
+/* Note where setup ends, allocations after this are in the data pass */
+void mark_job_data_pass(JobContext *ctx);
+
+/* Report the job's allocation counts, STEGO_COUNT_ALLOCS builds only */
+void print_job_allocations(const JobContext *ctx);
+
+/* Heap allocations made by the calling thread so far, 0 unless counted */
+uint64_t get_thread_allocations(void);
+
+#endif
@@ -0,0 +1,219 @@
+/***********************************************************************
+ *  File Name   : progress.c
+ *  Description : Source file for the Progress and Cancellation Module.
+ *                Jobs call update_job_progress() once per block, never
+ *                inside the kernels. Without a stream or callback that is
+ *                an add and a flag check; with one the clock is read too,
+ *                and a report goes out at most every PROGRESS_INTERVAL_NS.
+ *                Reports are single lines of "key=value" fields:
+ *                  progress job=<name> done=<bytes> total=<bytes>
+ *                           rate=<bytes/s> eta=<s> state=<running|done|
+ *                           failed|cancelled>
+ *                The name is percent-escaped (spaces, control bytes, '%'
+ *                and '='), so every field stays one space separated word.
+ *                Cancelling (Ctrl-C, SIGTERM, or a callback returning non
+ *                zero) makes the next block fail, and the job unwinds as
+ *                on any error. Named outputs are written to a temp file
+ *                next to them and renamed over the real name only when
+ *                the job succeeds, so a stopped job never leaves a partial
+ *                image or secret behind, nor damages an older output.
+ *
+ *                Functions:
+ *                - start_job_progress()
+ *                - update_job_progress()
+ *                - report_job_progress()
+ *                - format_job_progress()
+ *                - finish_job_progress()
+ *                - install_cancel_handlers()
+ *                - request_cancel()
+ *                - open_temp_output()
+ *                - commit_temp_output()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "types.h"
+#include "progress.h"
+
+/* Names tried for a temp output before giving up */
+#define TEMP_OUTPUT_TRIES 100
+
+/* Set from the signal handler, every job polls it at its block boundaries */
+static volatile sig_atomic_t cancel_requested;
+
+static uint64_t get_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void start_job_progress(JobProgress *progress, const char *job, uint64_t total)
+{
+    progress->job = job;
+    progress->done = 0;
+    progress->total = total;
+    progress->cancelled = 0;
+    progress->start_ns = progress->last_ns = get_time_ns();
+}
+
+Status update_job_progress(JobProgress *progress, uint64_t len)
+{
+    progress->done += len;
+    if(cancel_requested)
+        progress->cancelled = 1;
+    // The clock is only read when someone is listening
+    if(!progress->cancelled && (progress->stream || progress->callback) &&
+       get_time_ns() - progress->last_ns >= PROGRESS_INTERVAL_NS)
+        report_job_progress(progress, "running");
+    return progress->cancelled ? e_failure : e_success;
+}
+
+void report_job_progress(JobProgress *progress, const char *state)
+{
+    char line[PROGRESS_LINE_SIZE];
+    progress->last_ns = get_time_ns();
+    format_job_progress(progress, state, line, sizeof(line));
+    if(progress->stream)
+    {
+        fputs(line, progress->stream);
+        fflush(progress->stream);
+    }
+    if(progress->callback && progress->callback(progress, line, progress->callback_arg) != 0)
+        progress->cancelled = 1;
+}
+
+/* Percent-escape name into out, so a space or newline cannot split the line's fields */
+static void escape_progress_name(const char *name, char *out, size_t size)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    size_t len = 0;
+    for(const unsigned char *p = (const unsigned char *)name; *p && len + 4 <= size; p++)
+    {
+        if(*p <= ' ' || *p == 0x7f || *p == '%' || *p == '=')
+        {
+            out[len++] = '%';
+            out[len++] = hex[*p >> 4];
+            out[len++] = hex[*p & 0xf];
+        }
+        else
+            out[len++] = *p;
+    }
+    out[len] = '\0';
+}
+
+void format_job_progress(const JobProgress *progress, const char *state, char *line, size_t size)
+{
+    char name[PROGRESS_LINE_SIZE / 2];
+    escape_progress_name(progress->job ? progress->job : "-", name, sizeof(name));
+    double seconds = (progress->last_ns - progress->start_ns) / 1e9;
+    double rate = seconds > 0 ? progress->done / seconds : 0;
+    double eta = (rate > 0 && progress->total > progress->done) ? (progress->total - progress->done) / rate : 0;
+    snprintf(line, size, "progress job=%s done=%" PRIu64 " total=%" PRIu64 " rate=%.0f eta=%.2f state=%s\n",
+             name, progress->done, progress->total, rate, eta, state);
+}
+
+void finish_job_progress(JobProgress *progress, Status ret)
+{
+    // Jobs that never got to their data (e.g. cache hits) have nothing to report
+    if(progress->start_ns == 0)
+        return;
+    if(progress->cancelled)
+        fprintf(stderr, "Error: Job cancelled after %" PRIu64 " of %" PRIu64 " bytes\n", progress->done, progress->total);
+    if(progress->stream || progress->callback)
+        report_job_progress(progress, progress->cancelled ? "cancelled" : (ret == e_success ? "done" : "failed"));
+    progress->start_ns = 0;
+}
+
+void install_cancel_handlers(void)
+{
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = request_cancel;
+    sigemptyset(&sa.sa_mask);
+    // No SA_RESTART, a prompt waiting in scanf() gives up as well.
+    // The handler is one shot, a second Ctrl-C kills a stuck process
+    sa.sa_flags = SA_RESETHAND;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+}
+
+void request_cancel(int sig)
+{
+    (void)sig;
+    cancel_requested = 1;
+}
+
+FILE *open_temp_output(const char *fname, char *temp_fname, size_t size, const char *mode)
+{
+    static const char letters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+    static uint64_t counter;
+    size_t len = strlen(fname);
+    if(len + sizeof(TEMP_OUTPUT_SUFFIX) > size)
+    {
+        temp_fname[0] = '\0';
+        return NULL;
+    }
+    // Same directory as the output, so the final rename() cannot cross filesystems.
+    // Created like fopen() would (0666 less the umask) rather than with mkstemp()'s 0600
+    int fd = -1;
+    for(uint tries = 0; fd < 0 && tries < TEMP_OUTPUT_TRIES; tries++)
+    {
+        uint64_t seed = get_time_ns() ^ ((uint64_t)getpid() << 32) ^ __atomic_fetch_add(&counter, 0x9E3779B97F4A7C15ULL, __ATOMIC_RELAXED);
+        memcpy(temp_fname, fname, len);
+        temp_fname[len] = '.';
+        for(size_t i = 1; i < sizeof(TEMP_OUTPUT_SUFFIX) - 1; i++, seed /= sizeof(letters) - 1)
+            temp_fname[len + i] = letters[seed % (sizeof(letters) - 1)];
+        temp_fname[len + sizeof(TEMP_OUTPUT_SUFFIX) - 1] = '\0';
+        fd = open(temp_fname, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if(fd < 0 && errno != EEXIST)
+            break;
+    }
+    if(fd < 0)
+    {
+        temp_fname[0] = '\0';
+        return NULL;
+    }
+    // Replacing an output keeps its permissions, as truncating it in place did
+    struct stat st;
+    if(stat(fname, &st) == 0 && S_ISREG(st.st_mode))
+        fchmod(fd, st.st_mode & 07777);
+    FILE *fptr = fdopen(fd, mode);
+    if(fptr == NULL)
+    {
+        close(fd);
+        unlink(temp_fname);
+        temp_fname[0] = '\0';
+    }
+    return fptr;
+}
+
+Status commit_temp_output(char *temp_fname, const char *fname, Status ret)
+{
+    // Outputs handed in as descriptors have no temp name, they are the caller's
+    if(temp_fname[0] == '\0')
+        return ret;
+    if(ret == e_success && rename(temp_fname, fname) != 0)
+    {
+        perror("rename");
+        fprintf(stderr, "ERROR: Unable to move the output into place as \"%s\"\n", fname);
+        ret = e_failure;
+    }
+    if(ret == e_failure)
+        unlink(temp_fname);
+    temp_fname[0] = '\0';
+    return ret;
+}
@@ -0,0 +1,92 @@
+/***********************************************************************
+ *  File Name   : progress.h
+ *  Description : Header file for the Progress and Cancellation Module.
+ *                Contains the definitions and function declarations used
+ *                for reporting how far a job is (to a stream and/or a
+ *                callback), stopping it cleanly at the next block when it
+ *                is cancelled, and writing outputs under a temp name that
+ *                only replaces the real one once the job succeeds.
+ *
+ *                Structures:
+ *                - JobProgress
+ *
+ *                Functions:
+ *                - start_job_progress()
+ *                - update_job_progress()
+ *                - report_job_progress()
+ *                - format_job_progress()
+ *                - finish_job_progress()
+ *                - install_cancel_handlers()
+ *                - request_cancel()
+ *                - open_temp_output()
+ *                - commit_temp_output()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "types.h"
+#include "common.h"
+
+/* Least time between two progress reports */
+#define PROGRESS_INTERVAL_NS (200 * 1000000ULL)
+/* Longest progress line */
+#define PROGRESS_LINE_SIZE 256
+/* Temp outputs are "<name>.XXXXXX" in the same directory */
+#define TEMP_OUTPUT_SUFFIX ".XXXXXX"
+#define TEMP_FNAME_SIZE (MAX_FNAME + sizeof(TEMP_OUTPUT_SUFFIX) - 1)
+
+typedef struct _JobProgress JobProgress;
+
+/* Called with every report, a non zero return cancels the job */
+typedef int (*ProgressCallback)(const JobProgress *progress, const char *line, void *arg);
+
+struct _JobProgress
+{
+    FILE *stream;               // => Store where progress lines go (NULL => none)
+    ProgressCallback callback;  // => Store the caller's hook (NULL => none)
+    void *callback_arg;         // => Store the hook's own data
+    const char *job;            // => Store the name the lines carry
+    uint64_t done;              // => Store the bytes done so far
+    uint64_t total;             // => Store the bytes the job will do
+    uint64_t start_ns;          // => Store when the job started (0 => not started)
+    uint64_t last_ns;           // => Store when the last report went out
+    uint cancelled;             // => Store 1 once the job was cancelled
+
+};
+
+/* Start counting, total is in the job's own unit of bytes */
+void start_job_progress(JobProgress *progress, const char *job, uint64_t total);
+
+/* Add len bytes at a block boundary, fails once the job is cancelled */
+Status update_job_progress(JobProgress *progress, uint64_t len);
+
+/* Send one report to the stream and the callback */
+void report_job_progress(JobProgress *progress, const char *state);
+
+/* Build the machine readable line of a report, the job name percent-escaped */
+void format_job_progress(const JobProgress *progress, const char *state, char *line, size_t size);
+
+/* Last report with the job's outcome */
+void finish_job_progress(JobProgress *progress, Status ret);
+
+/* Ctrl-C / SIGTERM cancel the running jobs, a second one kills the process */
+void install_cancel_handlers(void);
+
+/* Signal handler behind install_cancel_handlers() */
+void request_cancel(int sig);
+
+/* Create "<fname>.XXXXXX" for writing with the umask or fname's current mode,
+   its name is left in temp_fname */
+FILE *open_temp_output(const char *fname, char *temp_fname, size_t size, const char *mode);
+
+/* Rename the temp output over fname on success, remove it otherwise */
+Status commit_temp_output(char *temp_fname, const char *fname, Status ret);
+
+#endif
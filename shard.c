@@ -0,0 +1,468 @@
+/***********************************************************************
+ *  File Name   : shard.c
+ *  Description : Source file for the Steganography Shard Module.
+ *                Splits one secret across N cover images in proportion
+ *                to their capacity and encodes the shards concurrently.
+ *                Every shard carries a header with its index, the shard
+ *                count and a payload id, so decoding can take the stego
+ *                images in any order and rebuild the secret in parallel.
+ *                Fan-out puts the whole secret into every cover instead,
+ *                each under its own key: the secret is read and FEC coded
+ *                once into a read only buffer that all the encode threads
+ *                embed from, so each cover only costs its own image copy.
+ *
+ *                Functions:
+ *                - read_and_validate_shard_args()
+ *                - do_shard_encoding()
+ *                - do_shard_decoding()
+ *                - do_fanout_encoding()
+ *                - prepare_fanout_payload()
+ *                - plan_shards()
+ *                - get_payload_id()
+ *                - shard_encode_worker()
+ *                - shard_decode_worker()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+/* 64-bit off_t for fseeko() on multi-gigabyte secrets */
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "types.h"
+#include "common.h"
+#include "encode.h"
+#include "decode.h"
+#include "shard.h"
+#include "fec.h"
+#include "matrix.h"
+
+Status read_and_validate_shard_args(int argc, char *argv[], int first_image, ShardInfo *shdInfo)
+{
+    shdInfo->image_count = argc - first_image;
+    if(shdInfo->image_count < 1 || shdInfo->image_count > MAX_SHARDS)
+    {
+        fprintf(stderr, "Error: Number of images should be between 1 and %d\n", MAX_SHARDS);
+        return e_failure;
+    }
+    shdInfo->image_fnames = &argv[first_image];
+    for(uint i = 0; i < shdInfo->image_count; i++)
+    {
+        char *ext = strrchr(shdInfo->image_fnames[i], '.');
+        if(ext == NULL || strcmp(ext, ".bmp") != 0 || strlen(shdInfo->image_fnames[i]) >= MAX_FNAME)
+        {
+            fprintf(stderr, "Error: Image \"%s\" Should be \".bmp\" File\n", shdInfo->image_fnames[i]);
+            return e_failure;
+        }
+    }
+    return e_success;
+}
+
+Status do_shard_encoding(ShardInfo *shdInfo)
+{
+    EncodeInfo jobs[MAX_SHARDS] = {0};
+    pthread_t workers[MAX_SHARDS];
+    uint count = shdInfo->image_count;
+    Status ret = e_success;
+
+    // "<prefix>_<index>.bmp" has to fit the output name buffer
+    if(strlen(shdInfo->out_prefix) + 8 >= MAX_FNAME)
+    {
+        fprintf(stderr, "Error: Output prefix \"%s\" is too long\n", shdInfo->out_prefix);
+        return e_failure;
+    }
+    // Size of the whole secret, every shard takes a slice of it
+    FILE *fptr_secret = fopen(shdInfo->secret_fname, "rb");
+    if(fptr_secret == NULL)
+    {
+        fprintf(stderr, "ERROR: No Secrat file found with name \"%s\"\n", shdInfo->secret_fname);
+        return e_failure;
+    }
+    uint64_t secret_size = get_file_size(fptr_secret);
+    fclose(fptr_secret);
+
+    // One key for all the shards, asked once
+    if(shdInfo->magic_string[0] == '\0')
+    {
+        printf("Enter the Magic string keys : ");
+        if(scanf(" %49s", shdInfo->magic_string) != 1)
+            return e_failure;
+    }
+
+    uint payload_id = get_payload_id();
+    for(uint i = 0; i < count; i++)
+    {
+        char out_fname[MAX_FNAME];
+        snprintf(out_fname, sizeof(out_fname), "%s_%u.bmp", shdInfo->out_prefix, i);
+        // Same validation as a plain encode job
+        char *job_argv[] = { "stego", "-e", shdInfo->image_fnames[i], shdInfo->secret_fname, out_fname, NULL };
+        if(read_and_validate_encode_args(job_argv, &jobs[i]) == e_failure)
+            return e_failure;
+        strcpy(jobs[i].magic_string, shdInfo->magic_string);
+        jobs[i].payload_id = payload_id;
+        jobs[i].shard_index = i;
+        jobs[i].shard_count = count;
+        jobs[i].fec_parity = shdInfo->fec_parity;
+        jobs[i].matrix_k = shdInfo->matrix_k;
+        jobs[i].verify = shdInfo->verify;
+        jobs[i].map_threads = shdInfo->map_threads;
+        jobs[i].progress.stream = shdInfo->progress_stream;
+    }
+    if(plan_shards(shdInfo, jobs, secret_size) == e_failure)
+    {
+        fprintf(stderr, "Error: File Size is incompatible to encode across %u images\n", count);
+        return e_failure;
+    }
+
+    // Every shard has its own files, so the shards run fully in parallel
+    for(uint i = 0; i < count; i++)
+    {
+        if(pthread_create(&workers[i], NULL, shard_encode_worker, &jobs[i]) != 0)
+        {
+            fprintf(stderr, "Error: Failed to start shard thread %u\n", i);
+            count = i;
+            ret = e_failure;
+            break;
+        }
+    }
+    for(uint i = 0; i < count; i++)
+    {
+        void *status;
+        pthread_join(workers[i], &status);
+        if((intptr_t)status != e_success)
+            ret = e_failure;
+    }
+    if(ret == e_success)
+        printf("Secret split into %u shards Successfully\n", count);
+    return ret;
+}
+
+Status do_fanout_encoding(ShardInfo *shdInfo)
+{
+    EncodeInfo jobs[MAX_SHARDS] = {0};
+    pthread_t workers[MAX_SHARDS];
+    uint count = shdInfo->image_count;
+    uint started = 0;
+    Status ret = e_success;
+    unsigned char *payload = NULL;
+    uint64_t payload_size, secret_size;
+
+    // "<prefix>_<index>.bmp" has to fit the output name buffer
+    if(strlen(shdInfo->out_prefix) + 8 >= MAX_FNAME)
+    {
+        fprintf(stderr, "Error: Output prefix \"%s\" is too long\n", shdInfo->out_prefix);
+        return e_failure;
+    }
+    if(shdInfo->keys && shdInfo->key_count < count)
+    {
+        fprintf(stderr, "Error: %u keys for %u covers, every cover needs its own key\n", shdInfo->key_count, count);
+        return e_failure;
+    }
+    if(prepare_fanout_payload(shdInfo, &payload, &payload_size, &secret_size) == e_failure)
+        return e_failure;
+
+    for(uint i = 0; i < count; i++)
+    {
+        char out_fname[MAX_FNAME];
+        snprintf(out_fname, sizeof(out_fname), "%s_%u.bmp", shdInfo->out_prefix, i);
+        // Same validation as a plain encode job
+        char *job_argv[] = { "stego", "-e", shdInfo->image_fnames[i], shdInfo->secret_fname, out_fname, NULL };
+        if(read_and_validate_encode_args(job_argv, &jobs[i]) == e_failure)
+        {
+            ret = e_failure;
+            goto cleanup;
+        }
+        // Keys from the list in cover order, or asked for each cover before any thread starts
+        if(shdInfo->keys)
+            strcpy(jobs[i].magic_string, shdInfo->keys[i]);
+        else
+        {
+            printf("Enter the Magic string keys for \"%s\" : ", shdInfo->image_fnames[i]);
+            if(scanf(" %49s", jobs[i].magic_string) != 1)
+            {
+                ret = e_failure;
+                goto cleanup;
+            }
+        }
+        jobs[i].payload = payload;
+        jobs[i].payload_size = payload_size;
+        jobs[i].secret_size = secret_size;
+        jobs[i].fec_parity = shdInfo->fec_parity;
+        jobs[i].matrix_k = shdInfo->matrix_k;
+        jobs[i].verify = shdInfo->verify;
+        jobs[i].map_threads = shdInfo->map_threads;
+        jobs[i].progress.stream = shdInfo->progress_stream;
+    }
+
+    // Covers only share the read only payload, so they run fully in parallel
+    for(; started < count; started++)
+    {
+        if(pthread_create(&workers[started], NULL, shard_encode_worker, &jobs[started]) != 0)
+        {
+            fprintf(stderr, "Error: Failed to start fan-out thread %u\n", started);
+            ret = e_failure;
+            break;
+        }
+    }
+    for(uint i = 0; i < started; i++)
+    {
+        void *status;
+        pthread_join(workers[i], &status);
+        if((intptr_t)status != e_success)
+            ret = e_failure;
+    }
+    if(ret == e_success)
+        printf("Secret copied into %u covers Successfully\n", count);
+
+cleanup:
+    free(payload);
+    return ret;
+}
+
+Status prepare_fanout_payload(ShardInfo *shdInfo, unsigned char **payload, uint64_t *payload_size, uint64_t *secret_size)
+{
+    FILE *fptr_secret = fopen(shdInfo->secret_fname, "rb");
+    if(fptr_secret == NULL)
+    {
+        fprintf(stderr, "ERROR: No Secrat file found with name \"%s\"\n", shdInfo->secret_fname);
+        return e_failure;
+    }
+    *secret_size = get_file_size(fptr_secret);
+    fseeko(fptr_secret, 0, SEEK_SET);
+    unsigned char *secret = malloc(*secret_size ? *secret_size : 1);
+    if(secret == NULL || (*secret_size && fread(secret, *secret_size, 1, fptr_secret) != 1))
+    {
+        fprintf(stderr, "Error: Unable to read the Secret file \"%s\" into memory\n", shdInfo->secret_fname);
+        fclose(fptr_secret);
+        free(secret);
+        return e_failure;
+    }
+    fclose(fptr_secret);
+    *payload = secret;
+    *payload_size = *secret_size;
+    if(shdInfo->fec_parity == 0)
+        return e_success;
+
+    // Parity depends on the secret alone, so every cover embeds the same coded bytes
+    const FecCodec *codec = get_fec_codec(shdInfo->fec_parity);
+    *payload_size = get_fec_encoded_size(*secret_size, shdInfo->fec_parity);
+    unsigned char *coded = malloc(*payload_size ? *payload_size : 1);
+    if(coded == NULL || codec == NULL)
+    {
+        free(secret);
+        free(coded);
+        return e_failure;
+    }
+    // Same whole codeword chunks as encode_secret_file_data() uses
+    size_t chunk_limit = FEC_BLOCKS_PER_CHUNK * (FEC_BLOCK_SIZE - shdInfo->fec_parity);
+    uint64_t out = 0;
+    for(uint64_t done = 0; done < *secret_size; )
+    {
+        size_t chunk = *secret_size - done < chunk_limit ? *secret_size - done : chunk_limit;
+        out += encode_fec_chunk(codec, secret + done, chunk, coded + out);
+        done += chunk;
+    }
+    free(secret);
+    *payload = coded;
+    return e_success;
+}
+
+Status plan_shards(ShardInfo *shdInfo, EncodeInfo *jobs, uint64_t secret_size)
+{
+    uint64_t capacity[MAX_SHARDS];
+    uint64_t total = 0;
+
+    // Payload bytes each cover can hold after its own header
+    for(uint i = 0; i < shdInfo->image_count; i++)
+    {
+        FILE *fptr_image = fopen(jobs[i].src_image_fname, "rb");
+        if(fptr_image == NULL)
+        {
+            fprintf(stderr, "ERROR: No Source file found with name \"%s\"\n", jobs[i].src_image_fname);
+            return e_failure;
+        }
+        const BmpFormat *format;
+        uint pixel_offset;
+        if(get_bmp_format(fptr_image, &format, &pixel_offset) == e_failure)
+        {
+            fclose(fptr_image);
+            return e_failure;
+        }
+        uint64_t bytes = get_image_size_for_bmp(fptr_image) / format->group_size;
+        uint64_t header = get_header_size(&jobs[i]);
+        fclose(fptr_image);
+        capacity[i] = bytes > header ? bytes - header : 0;
+        // Matrix units and parity bytes eat into the room left for data
+        if(shdInfo->matrix_k)
+            capacity[i] = get_matrix_data_capacity(capacity[i], shdInfo->matrix_k);
+        if(shdInfo->fec_parity)
+            capacity[i] = get_fec_data_capacity(capacity[i], shdInfo->fec_parity);
+        total += capacity[i];
+    }
+    if(total < secret_size)
+        return e_failure;
+
+    // Slices proportional to capacity, so every image fills up evenly
+    uint64_t planned = 0;
+    for(uint i = 0; i < shdInfo->image_count; i++)
+    {
+        jobs[i].secret_size = (uint64_t)((long double)secret_size * capacity[i] / total);
+        if(jobs[i].secret_size > capacity[i])
+            jobs[i].secret_size = capacity[i];
+        planned += jobs[i].secret_size;
+    }
+    // Rounding leftovers go wherever there is room
+    for(uint i = 0; i < shdInfo->image_count && planned < secret_size; i++)
+    {
+        uint64_t extra = capacity[i] - jobs[i].secret_size;
+        if(extra > secret_size - planned)
+            extra = secret_size - planned;
+        jobs[i].secret_size += extra;
+        planned += extra;
+    }
+    // Slices are laid out back to back in index order
+    uint64_t offset = 0;
+    for(uint i = 0; i < shdInfo->image_count; i++)
+    {
+        jobs[i].secret_offset = offset;
+        offset += jobs[i].secret_size;
+    }
+    return e_success;
+}
+
+uint get_payload_id(void)
+{
+    uint id;
+    FILE *fptr = fopen("/dev/urandom", "rb");
+    if(fptr != NULL && fread(&id, sizeof(id), 1, fptr) == 1)
+    {
+        fclose(fptr);
+        return id;
+    }
+    if(fptr != NULL)
+        fclose(fptr);
+    // No urandom, time and pid still tell two runs apart
+    return (uint)time(NULL) ^ ((uint)getpid() << 16);
+}
+
+void *shard_encode_worker(void *arg)
+{
+    return (void *)(intptr_t)do_encoding(arg);
+}
+
+Status do_shard_decoding(ShardInfo *shdInfo)
+{
+    DecodeInfo jobs[MAX_SHARDS] = {0};
+    DecodeInfo *order[MAX_SHARDS] = {NULL};
+    pthread_t workers[MAX_SHARDS];
+    uint count = shdInfo->image_count;
+    uint started = 0;
+    Status ret = e_failure;
+
+    // One key for all the shards, asked once
+    if(shdInfo->magic_string[0] == '\0')
+    {
+        printf("Enter the magic string kays : ");
+        if(scanf(" %49s", shdInfo->magic_string) != 1)
+            return e_failure;
+    }
+
+    // Reading every shard header first, they say where each slice goes
+    for(uint i = 0; i < count; i++)
+    {
+        char *job_argv[] = { "stego", "-d", shdInfo->image_fnames[i], shdInfo->secret_fname, NULL };
+        if(read_and_validate_decode_args(job_argv, &jobs[i]) == e_failure)
+            goto cleanup;
+        strcpy(jobs[i].magic_string, shdInfo->magic_string);
+        jobs[i].progress.stream = shdInfo->progress_stream;
+        if(open_image_file(&jobs[i]) == e_failure || decode_stego_header(&jobs[i]) == e_failure)
+            goto cleanup;
+        if(!(jobs[i].flags & STEGO_FLAG_SHARD))
+        {
+            fprintf(stderr, "Error: \"%s\" is not a shard image\n", jobs[i].stego_image_fname);
+            goto cleanup;
+        }
+        if(jobs[i].shard_count != count)
+        {
+            fprintf(stderr, "Error: Secret needs %u shards, %u given\n", jobs[i].shard_count, count);
+            goto cleanup;
+        }
+        if(jobs[i].payload_id != jobs[0].payload_id || strcmp(jobs[i].extn_secret_file, jobs[0].extn_secret_file) != 0)
+        {
+            fprintf(stderr, "Error: \"%s\" does not belong with \"%s\"\n", jobs[i].stego_image_fname, jobs[0].stego_image_fname);
+            goto cleanup;
+        }
+        if(order[jobs[i].shard_index] != NULL)
+        {
+            fprintf(stderr, "Error: Shard %u given twice\n", jobs[i].shard_index + 1);
+            goto cleanup;
+        }
+        order[jobs[i].shard_index] = &jobs[i];
+    }
+
+    // First shard creates the output with the decoded extension,
+    // the others write their slice into it at their own offset
+    if(open_secret_file(order[0]) == e_failure)
+        goto cleanup;
+    uint64_t offset = order[0]->secret_size;
+    for(uint i = 1; i < count; i++)
+    {
+        // Every slice goes into the first shard's temp file, renamed once all are in
+        strcpy(order[i]->secret_fname, order[0]->secret_fname);
+        order[i]->fptr_secret = fopen(order[0]->secret_temp_fname, "r+b");
+        if(order[i]->fptr_secret == NULL || fseeko(order[i]->fptr_secret, offset, SEEK_SET) != 0)
+        {
+            perror("fopen");
+            fprintf(stderr, "ERROR: Unable to open file %s\n", order[i]->secret_fname);
+            goto cleanup;
+        }
+        offset += order[i]->secret_size;
+    }
+
+    ret = e_success;
+    for(uint i = 0; i < count; i++)
+    {
+        if(pthread_create(&workers[i], NULL, shard_decode_worker, order[i]) != 0)
+        {
+            fprintf(stderr, "Error: Failed to start shard thread %u\n", i);
+            ret = e_failure;
+            break;
+        }
+        started++;
+    }
+    for(uint i = 0; i < started; i++)
+    {
+        void *status;
+        pthread_join(workers[i], &status);
+        if((intptr_t)status != e_success)
+            ret = e_failure;
+    }
+
+cleanup:
+    for(uint i = 0; i < count; i++)
+    {
+        close_decode_files(&jobs[i]);
+        finish_job_progress(&jobs[i].progress, ret);
+    }
+    // Only the first shard has a temp name, the whole secret appears at once or not at all
+    for(uint i = 0; i < count; i++)
+        ret = commit_temp_output(jobs[i].secret_temp_fname, jobs[i].secret_fname, ret);
+    if(ret == e_success)
+        printf("Secret rebuilt from %u shards into \"%s\" Successfully\n", count, order[0]->secret_fname);
+    return ret;
+}
+
+void *shard_decode_worker(void *arg)
+{
+    // Header is already read, the image is positioned at the shard's data
+    return (void *)(intptr_t)decode_secret_file_data(arg);
+}
@@ -0,0 +1,86 @@
+/***********************************************************************
+ *  File Name   : shard.h
+ *  Description : Header file for the Steganography Shard Module.
+ *                Contains structure definition and function declarations
+ *                used for splitting one secret across several cover images
+ *                and putting it back together, or copying a whole secret
+ *                into several covers, one thread per image.
+ *
+ *                Structures:
+ *                - ShardInfo
+ *
+ *                Functions:
+ *                - read_and_validate_shard_args()
+ *                - do_shard_encoding()
+ *                - do_shard_decoding()
+ *                - do_fanout_encoding()
+ *                - prepare_fanout_payload()
+ *                - plan_shards()
+ *                - get_payload_id()
+ *                - shard_encode_worker()
+ *                - shard_decode_worker()
+ *
+ *  Author      : Pankaj Kumar
+ *  Roll No     : 25008_018
+ *  Date        : 30-Jul-2025
+ ***********************************************************************/
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "types.h"
+#include "common.h"
+#include "encode.h"
+#include "decode.h"
+
+#define MAX_SHARDS 64
+
+typedef struct _ShardInfo
+{
+    /* Secret File Info */
+    char *secret_fname;         // => Store the Secret (encode) or output (decode) file name
+
+    /* Image Info */
+    char *out_prefix;           // => Store the prefix of the shard images (encode)
+    char **image_fnames;        // => Store the cover (encode) or shard (decode) image names
+    uint image_count;           // => Store the number of images
+
+    char magic_string[MAX_MAGIC_LEN + 1]; // => Store the Magic String shared by all shards
+    uint fec_parity;            // => Store RS parity bytes per codeword (0 => no FEC)
+    uint matrix_k;              // => Store message bits per Hamming unit (0 => plain LSB)
+    uint verify;                // => Store the VERIFY_* level for every shard
+    uint map_threads;           // => Store the mapped tail copy threads for every shard (0 => stdio)
+    FILE *progress_stream;      // => Store where every job's progress lines go (NULL => none)
+    char **keys;                // => Store one Magic String per cover (fan-out, NULL => prompt)
+    uint key_count;             // => Store the number of keys
+
+} ShardInfo;
+
+/* Read and validate Shard args from argv, images start at argv[first_image] */
+Status read_and_validate_shard_args(int argc, char *argv[], int first_image, ShardInfo *shdInfo);
+
+/* Split the secret across all the covers */
+Status do_shard_encoding(ShardInfo *shdInfo);
+
+/* Put the secret back together from all the shards, in any order */
+Status do_shard_decoding(ShardInfo *shdInfo);
+
+/* Encode the whole secret into every cover, each with its own key */
+Status do_fanout_encoding(ShardInfo *shdInfo);
+
+/* Read the secret once and FEC code it, the result is shared by every cover */
+Status prepare_fanout_payload(ShardInfo *shdInfo, unsigned char **payload, uint64_t *payload_size, uint64_t *secret_size);
+
+/* Work out every shard's slice of the secret from the cover capacities */
+Status plan_shards(ShardInfo *shdInfo, EncodeInfo *jobs, uint64_t secret_size);
+
+/* Get a random id tying the shards of one secret together */
+uint get_payload_id(void);
+
+/* Thread entry, encodes one shard or fan-out copy */
+void *shard_encode_worker(void *arg);
+
+/* Thread entry, decodes one shard's data */
+void *shard_decode_worker(void *arg);
+
+#endif
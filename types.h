@@ -5,10 +5,14 @@
  *
  *                Type Definitions:
  *                - uint          : Unsigned integer alias for brevity.
+ *                - uint64_t      : 64-bit sizes and offsets (from stdint.h).
  *                - Status        : Enum for function return statuses 
  *                                   (e_success, e_failure).
  *                - OperationType : Enum for operation mode (encoding,
- *                                   decoding, or unsupported).
+ *                                   decoding, daemon, shard
+ *                                   encoding/decoding, fan-out
+ *                                   encoding, benchmark or
+ *                                   unsupported).
  *
  *  Author      : Pankaj Kumar
  *  Roll No     : 25008_018
@@ -18,6 +22,8 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <stdint.h>
+
 /* User defined types */
 typedef unsigned int uint;
 
@@ -32,6 +38,11 @@ typedef enum
 {
     e_encode,
     e_decode,
+    e_daemon,
+    e_shard_encode,
+    e_shard_decode,
+    e_fanout_encode,
+    e_benchmark,
     e_unsupported
 } OperationType;
 #endif